@@ -0,0 +1,39 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+// Error-bounded chunk triangulation: a right-triangulated irregular network
+// (RTIN) over the chunk's (2^n + 1)^2 heightfield, the restricted quadtree
+// of Martini. Vertices use the grid numbering of GridIndices.h.
+
+// How chunk triangles are chosen, selected by terrain.meshMode
+enum class MeshMode {
+    GRID,    // Every grid cell, from the shared ChunkIndexCache lists
+    ADAPTIVE // Per-chunk RTIN within terrain.adaptiveMaxError
+};
+
+MeshMode parseMeshMode(const std::string& name);
+const char* meshModeName(MeshMode mode);
+
+// RTIN only subdivides grids of 2^n + 1 vertices
+bool canBuildAdaptiveMesh(int vertexResolution);
+
+// Vertical error of leaving out each vertex: its distance from the
+// hypotenuse it splits, raised to the error of every vertex whose triangles
+// can only be split after it. errors and heights are row-major
+// vertexResolution^2. Corner vertices are always present and get 0.
+void rtinErrors(std::span<const float> heights, int vertexResolution, std::span<float> errors);
+
+// Counter-clockwise (seen from +Y) triangles of the coarsest RTIN whose
+// vertices' errors are at most maxError. Every vertex on the chunk's edges
+// is kept, so neighbours meet exactly without looking at each other's
+// heights. Along each edge in stitchedEdges the odd vertices are left out
+// instead, following the coarser neighbour as buildGridTriangles() does.
+std::vector<unsigned int> buildAdaptiveTriangles(std::span<const float> errors, int vertexResolution, float maxError,
+                                                 unsigned int stitchedEdges = 0);
+
+// Largest vertical distance between the heightfield's grid samples and the
+// triangles over them
+float triangulationError(std::span<const float> heights, int vertexResolution, std::span<const unsigned int> triangles);
\ No newline at end of file
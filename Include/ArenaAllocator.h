@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// Free-list sub-allocation of one large buffer. Ranges are in whatever unit
+// the caller counts (vertices, indices), taken first-fit and merged with
+// their free neighbours on release. Allocations are referred to by handle,
+// so compact() can move them without the owners noticing.
+class ArenaAllocator {
+public:
+    using Handle = int;
+    static constexpr Handle NONE = -1;
+    
+    // One copy that rebuilds the compacted layout from the old one
+    struct Move {
+        std::size_t from;
+        std::size_t to;
+        std::size_t size;
+    };
+    
+    explicit ArenaAllocator(std::size_t capacity = 0);
+    
+    // NONE if no single free range is large enough; compact() or grow() first
+    Handle allocate(std::size_t size);
+    void release(Handle handle);
+    
+    std::size_t getOffset(Handle handle) const { return ranges[handle].offset; }
+    std::size_t getSize(Handle handle) const { return ranges[handle].size; }
+    
+    // Packs every allocation to the front, keeping their order, so all free
+    // space is one range at the end. Returns the copies from the old layout
+    // to the new one, every live range included and neighbours merged.
+    std::vector<Move> compact();
+    
+    // Capacity only ever grows; the new space joins the free range at the end
+    void grow(std::size_t capacity);
+    
+    std::size_t getCapacity() const { return capacity; }
+    std::size_t getUsed() const { return used; }
+    std::size_t getLargestFree() const;
+    std::size_t getFreeRangeCount() const { return freeRanges.size(); }
+    std::size_t getAllocationCount() const { return ranges.size() - freeHandles.size(); }
+    
+private:
+    struct Range {
+        std::size_t offset;
+        std::size_t size;
+    };
+    
+    std::size_t capacity;
+    std::size_t used;
+    std::map<std::size_t, std::size_t> freeRanges; // Offset to size
+    std::vector<Range> ranges;                     // By handle
+    std::vector<Handle> freeHandles;
+    
+    void addFree(std::size_t offset, std::size_t size);
+};
\ No newline at end of file
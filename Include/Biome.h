@@ -2,7 +2,12 @@
 
 #include <glm/glm.hpp>
 #include "Perlin.h"
+#include "ClimateRaster.h"
+#include "BiomeTable.h"
 
+// The built-in biomes, matched to a BiomeTable's ids by name. The BiomeType
+// overloads throw std::out_of_range for a biome the table does not have,
+// or one configured under another name.
 enum class BiomeType {
     DESERT,
     FOREST,
@@ -20,22 +25,65 @@ struct BiomeParams {
     float colorThreshold2;
 };
 
+// Per-biome heights at one point and the weights they are blended with.
+// generateHeight() returns the weighted sum of heights[0..weights.count).
+// gradients are each biome's world-space (dh/dx, dh/dz).
+struct BiomeHeights {
+    BiomeWeights weights;
+    float heights[BiomeWeights::MAX_BIOMES];
+    glm::vec2 gradients[BiomeWeights::MAX_BIOMES];
+};
+
+// Blended terrain height at one point, its world-space gradient and the
+// blended biome color at that height. The gradient treats the blend
+// weights as locally constant; they vary over BLEND_DISTANCE while the
+// height noise varies over a few units, so that term is negligible.
+struct BiomeSample {
+    float height;
+    glm::vec2 gradient;
+    glm::vec3 color;
+};
+
 class BiomeGenerator {
 private:
-    PerlinNoise biomeNoise;
+    BiomeTable table;
+    ClimateRaster climate;
     
-    static const BiomeParams DESERT_PARAMS;
-    static const BiomeParams FOREST_PARAMS;
-    static const BiomeParams MOUNTAIN_PARAMS;
-    static const BiomeParams TUNDRA_PARAMS;
+    // Single-octave values of every height noise layer at one point
+    struct HeightLayers;
+    
+    glm::vec3 getColorForBiome(int id, float height) const;
+    BiomeHeights combineLayers(float x, float z, const HeightLayers& layers, const BiomeWeights& weights) const;
+    BiomeSample blendSample(const BiomeHeights& heights) const;
+    BiomeType toBiomeType(int id) const;
+    int toBiomeId(BiomeType type) const;
     
 public:
-    BiomeGenerator(unsigned int seed = 12345);
+    BiomeGenerator(unsigned int seed = 12345, BiomeTable table = BiomeTable());
     
     BiomeType getBiome(float x, float z) const;
+    int getBiomeId(float x, float z) const;
     BiomeParams getBiomeParams(BiomeType type) const;
+    BiomeParams getBiomeParams(int id) const;
+    const BiomeTable& getBiomeTable() const { return table; }
     float getBiomeBlend(float x, float z, BiomeType& primary, BiomeType& secondary) const;
+    BiomeWeights getBiomeWeights(float x, float z) const;
     
     float generateHeight(float x, float z, const PerlinNoise& heightNoise) const;
+    BiomeHeights generateHeights(float x, float z, const PerlinNoise& heightNoise) const;
     glm::vec3 getColor(float x, float z, float height, const PerlinNoise& heightNoise) const;
+    
+    // Height, gradient and color in one pass, sharing the blend weights
+    BiomeSample sample(float x, float z, const PerlinNoise& heightNoise) const;
+    
+    // sample() over the grid xs x zs, row-major (out[j * xs.size() + i] is
+    // at xs[i], zs[j]). The noise layers are evaluated with the
+    // lattice-coherent PerlinNoise::evaluateGrid; results are identical to
+    // per-point sample().
+    void sampleGrid(std::span<const float> xs, std::span<const float> zs,
+                    const PerlinNoise& heightNoise, std::span<BiomeSample> out) const;
+    
+    // The climate classifier refers back to this generator's table
+    BiomeGenerator(const BiomeGenerator&) = delete;
+    BiomeGenerator& operator=(const BiomeGenerator&) = delete;
 };
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <map>
+#include <string>
+#include <vector>
+#include "Config.h"
+
+// Terrain features layered on top of a biome's noise height
+enum class BiomeFeature {
+    NONE,
+    DUNES,
+    PEAKS
+};
+
+// Biome parameters in structure-of-arrays form, indexed by a dense biome id.
+// Ids follow the order of Config::biomes (alphabetical by name); the
+// built-in defaults are used when no biomes are configured. BiomeGenerator
+// maps BiomeType to these ids by name.
+class BiomeTable {
+public:
+    BiomeTable();
+    explicit BiomeTable(const std::map<std::string, BiomeConfig>& biomes);
+    
+    int size() const { return static_cast<int>(names.size()); }
+    int findId(const std::string& name) const; // -1 if unknown
+    
+    // Id of the biome whose climate center is nearest (temperature, moisture)
+    int classify(float temperature, float moisture) const;
+    
+    std::vector<std::string> names;
+    std::vector<float> heightScale;
+    std::vector<float> roughness;
+    std::vector<glm::vec3> baseColor;
+    std::vector<glm::vec3> midColor;
+    std::vector<glm::vec3> peakColor;
+    std::vector<float> colorThreshold1;
+    std::vector<float> colorThreshold2;
+    std::vector<glm::vec2> climate;
+    std::vector<BiomeFeature> feature;
+    
+private:
+    void add(const std::string& name, const BiomeConfig& biome);
+    void addDefaults();
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <span>
+#include <vector>
+#include "ArenaAllocator.h"
+#include "ChunkIndexCache.h"
+#include "VertexFormat.h"
+
+// One vertex buffer and one element buffer for every chunk, sub-allocated
+// with ArenaAllocator, behind a single VAO. The ChunkIndexCache patterns
+// sit at the front of the element buffer and adaptive meshes take their own
+// ranges after them, so a whole pass is one glMultiDrawElementsIndirect per
+// primitive mode, each draw finding its chunk through ChunkAttributes.
+//
+// Full arenas are compacted into a fresh buffer, or grown when compaction
+// would leave less than a quarter free. Handles stay valid across that;
+// offsets and getVertexBuffer() do not.
+class ChunkArena {
+public:
+    using Handle = ArenaAllocator::Handle;
+    
+    // One chunk's draw; attributes.base is also its base vertex
+    struct Draw {
+        GLenum mode;
+        GLuint count;
+        GLuint firstIndex;
+        ChunkAttributes attributes;
+    };
+    
+    // vertexCapacity is the starting size in vertices. With morphing the
+    // vertex buffer is also a GL_R32UI buffer texture (LodMode::MORPH).
+    ChunkArena(VertexFormat format, std::size_t vertexCapacity, const ChunkIndexCache& indexCache, bool morphing);
+    ~ChunkArena();
+    
+    Handle allocateVertices(std::size_t count);
+    void releaseVertices(Handle& handle); // Resets handle to NONE
+    std::size_t getFirstVertex(Handle handle) const { return vertices.getOffset(handle); }
+    std::size_t getVertexByteOffset(Handle handle) const { return vertices.getOffset(handle) * vertexStride; }
+    GLuint getVertexBuffer() const { return vertexBuffer; }
+    
+    // Stored as the index cache's type, which every draw in a pass shares
+    Handle uploadIndices(std::span<const unsigned int> data);
+    void releaseIndices(Handle& handle);
+    GLuint getFirstIndex(Handle handle) const { return static_cast<GLuint>(sharedIndexCount + indices.getOffset(handle)); }
+    GLuint getFirstIndex(const ChunkIndexCache::IndexBuffer& shared) const { return static_cast<GLuint>(shared.offset / indexSize); }
+    
+    // Binds the buffer texture to the active texture unit when there is one.
+    // Returns the number of GL draw calls issued.
+    int draw(std::span<const Draw> draws);
+    
+    bool usesMultiDrawIndirect() const { return multiDrawIndirect; }
+    std::size_t getBytes() const;
+    std::size_t getUsedBytes() const;
+    std::size_t getFreeRangeCount() const { return vertices.getFreeRangeCount() + indices.getFreeRangeCount(); }
+    int getRelocationCount() const { return relocations; }
+    
+    ChunkArena(const ChunkArena&) = delete;
+    ChunkArena& operator=(const ChunkArena&) = delete;
+    
+private:
+    // glMultiDrawElementsIndirect's command layout
+    struct DrawCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+    
+    VertexFormat format;
+    std::size_t vertexStride;
+    GLenum indexType;
+    std::size_t indexSize;
+    std::size_t sharedIndexCount; // ChunkIndexCache indices at the front
+    bool multiDrawIndirect;
+    bool perDrawAttributes; // Whether the shaders read ChunkAttributes for this format at all
+    
+    ArenaAllocator vertices; // In vertices
+    ArenaAllocator indices;  // In indices, after the shared ones
+    GLuint VAO;
+    GLuint vertexBuffer;
+    GLuint indexBuffer;
+    GLuint vertexTexture; // 0 without morphing
+    GLuint attributeBuffer;
+    GLuint commandBuffer;
+    int relocations;
+    
+    // Per draw call, kept for their capacity
+    std::vector<Draw> sorted;
+    std::vector<ChunkAttributes> attributes;
+    std::vector<DrawCommand> commands;
+    std::vector<GLsizei> counts;
+    std::vector<const void*> offsets;
+    std::vector<GLint> baseVertices;
+    
+    Handle allocate(ArenaAllocator& allocator, std::size_t size, bool vertexRange);
+    void relocate(GLuint& buffer, std::size_t unitSize, std::size_t keptBytes, const std::vector<ArenaAllocator::Move>& moves,
+                  std::size_t capacityBytes);
+    void bindBuffers();
+};
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <vector>
+#include "GridIndices.h"
+
+// Immutable element buffer shared by every chunk. A chunk's index list
+// depends only on its vertex resolution and which of its edges are
+// stitched to a coarser neighbour, so all 16 edge variants of every LOD
+// are built once and uploaded together into one buffer, already ordered
+// for the post-transform vertex cache (see VertexCache.h).
+class ChunkIndexCache {
+public:
+    // Everything a chunk needs for glDrawElements
+    struct IndexBuffer {
+        int vertexResolution;
+        GLuint buffer;
+        std::size_t offset; // Byte offset of this LOD and edge variant in buffer
+        GLsizei count;
+        GLenum mode; // GL_TRIANGLES or GL_TRIANGLE_STRIP
+        GLenum type; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    };
+    
+    ChunkIndexCache(int resolution, int lodLevels, IndexEncoding encoding = IndexEncoding::TRIANGLES);
+    ~ChunkIndexCache();
+    
+    // lod is clamped to the levels the cache was built with; stitchedEdges
+    // is a ChunkEdge mask
+    const IndexBuffer& get(int lod, unsigned int stitchedEdges = 0) const;
+    
+    int getLodLevels() const { return static_cast<int>(buffers.size() / EDGE_MASK_COUNT); }
+    std::size_t getBytes() const { return bufferBytes; }
+    GLuint getBuffer() const { return buffer; }
+    IndexEncoding getEncoding() const { return encoding; }
+    GLenum getIndexType() const { return indexType; }
+    
+    // Strips need GL_PRIMITIVE_RESTART enabled with this index while drawing
+    bool usesPrimitiveRestart() const { return encoding == IndexEncoding::STRIPS; }
+    GLuint getRestartIndex() const { return indexType == GL_UNSIGNED_SHORT ? 0xFFFFu : 0xFFFFFFFFu; }
+    
+    // Grid resolution at a LOD, see lodVertexResolution()
+    static int vertexResolution(int resolution, int lod) { return lodVertexResolution(resolution, lod); }
+    
+    // Edges of a chunk at lod that border a coarser neighbour. Missing
+    // neighbours (LOD -1) are not stitched.
+    static unsigned int stitchedEdges(int lod, int northLOD, int southLOD, int eastLOD, int westLOD);
+    
+    ChunkIndexCache(const ChunkIndexCache&) = delete;
+    ChunkIndexCache& operator=(const ChunkIndexCache&) = delete;
+    
+private:
+    IndexEncoding encoding;
+    GLenum indexType;
+    GLuint buffer = 0;
+    std::size_t bufferBytes = 0;
+    std::vector<IndexBuffer> buffers; // EDGE_MASK_COUNT entries per LOD
+};
\ No newline at end of file
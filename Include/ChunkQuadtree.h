@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Frustum.h"
+
+struct ChunkHash {
+    std::size_t operator()(const glm::ivec2& k) const {
+        return std::hash<int>()(k.x) ^ (std::hash<int>()(k.y) << 1);
+    }
+};
+
+// Chunks by coordinate in a quadtree whose nodes carry the merged bounds
+// and LOD range of the chunks under them, so culling and LOD selection
+// accept or reject whole subtrees. The plane is tiled with blocks of
+// BLOCK_SIZE x BLOCK_SIZE chunks, each a complete quadtree that is created
+// with its first chunk and dropped with its last.
+//
+// T owns a chunk through a pointer-like handle with getBoundsMin(),
+// getBoundsMax() and getLOD(). The traversals below refit the nodes they
+// pass through; anything else that changes a chunk calls refit().
+template <typename T>
+class ChunkQuadtree {
+public:
+    using Chunk = decltype(&*std::declval<T&>());
+    
+    static constexpr int LEVELS = 5;
+    static constexpr int BLOCK_SIZE = 1 << LEVELS;
+    
+    T* find(glm::ivec2 coord) {
+        auto it = blocks.find(blockOf(coord));
+        if (it == blocks.end()) {
+            return nullptr;
+        }
+        T& chunk = it->second->chunks[leafIndex(coord - it->second->origin)];
+        return chunk ? &chunk : nullptr;
+    }
+    
+    const T* find(glm::ivec2 coord) const {
+        return const_cast<ChunkQuadtree*>(this)->find(coord);
+    }
+    
+    std::size_t size() const { return count; }
+    std::size_t getBlockCount() const { return blocks.size(); }
+    
+    // Replaces any chunk already at coord
+    void insert(glm::ivec2 coord, T chunk) {
+        std::unique_ptr<Block>& block = blocks[blockOf(coord)];
+        if (!block) {
+            block = std::make_unique<Block>();
+            block->origin = blockOf(coord) * BLOCK_SIZE;
+        }
+        glm::ivec2 local = coord - block->origin;
+        T& slot = block->chunks[leafIndex(local)];
+        if (!slot) {
+            count++;
+        }
+        slot = std::move(chunk);
+        refitPath(*block, local);
+    }
+    
+    // An empty T if there was no chunk at coord
+    T extract(glm::ivec2 coord) {
+        auto it = blocks.find(blockOf(coord));
+        if (it == blocks.end()) {
+            return T{};
+        }
+        Block& block = *it->second;
+        glm::ivec2 local = coord - block.origin;
+        T chunk = std::move(block.chunks[leafIndex(local)]);
+        block.chunks[leafIndex(local)] = T{};
+        if (chunk) {
+            count--;
+        }
+        refitPath(block, local);
+        if (block.nodes[0].count == 0) {
+            blocks.erase(it);
+        }
+        return chunk;
+    }
+    
+    void refit(glm::ivec2 coord) {
+        auto it = blocks.find(blockOf(coord));
+        if (it != blocks.end()) {
+            refitPath(*it->second, coord - it->second->origin);
+        }
+    }
+    
+    // f(coord, chunk) for every chunk
+    template <typename F>
+    void forEach(F&& f) const {
+        for (const auto& [key, block] : blocks) {
+            for (int i = 0; i < BLOCK_SIZE * BLOCK_SIZE; ++i) {
+                if (block->chunks[i]) {
+                    f(block->origin + glm::ivec2(i % BLOCK_SIZE, i / BLOCK_SIZE), block->chunks[i]);
+                }
+            }
+        }
+    }
+    
+    // Removes every chunk outside the window, inclusive, handing each to
+    // take(coord, T&&). Subtrees wholly inside the window are not visited.
+    template <typename F>
+    void removeOutside(glm::ivec2 windowMin, glm::ivec2 windowMax, F&& take) {
+        for (auto it = blocks.begin(); it != blocks.end();) {
+            Block& block = *it->second;
+            removeOutside(block, 0, 0, 0, windowMin, windowMax, take);
+            it = block.nodes[0].count == 0 ? blocks.erase(it) : std::next(it);
+        }
+    }
+    
+    // f(coord) for every coordinate in the window, inclusive, that has no
+    // chunk. Full subtrees are skipped. Insert afterwards, not from f.
+    template <typename F>
+    void forEachMissing(glm::ivec2 windowMin, glm::ivec2 windowMax, F&& f) const {
+        glm::ivec2 first = blockOf(windowMin);
+        glm::ivec2 last = blockOf(windowMax);
+        for (int by = first.y; by <= last.y; ++by) {
+            for (int bx = first.x; bx <= last.x; ++bx) {
+                auto it = blocks.find(glm::ivec2(bx, by));
+                if (it != blocks.end()) {
+                    forEachMissing(*it->second, 0, 0, 0, windowMin, windowMax, f);
+                    continue;
+                }
+                glm::ivec2 origin = glm::ivec2(bx, by) * BLOCK_SIZE;
+                for (int y = std::max(origin.y, windowMin.y); y <= std::min(origin.y + BLOCK_SIZE - 1, windowMax.y); ++y) {
+                    for (int x = std::max(origin.x, windowMin.x); x <= std::min(origin.x + BLOCK_SIZE - 1, windowMax.x); ++x) {
+                        f(glm::ivec2(x, y));
+                    }
+                }
+            }
+        }
+    }
+    
+    // bandOf(coordMin, coordMax) is the LOD that every chunk in the
+    // rectangle, inclusive, would select, or -1 if they would not all agree.
+    // Subtrees already wholly at that LOD are skipped; every other chunk goes
+    // to f(coord, chunk), which may regenerate it. Returns the nodes visited.
+    template <typename Band, typename F>
+    std::size_t updateLods(Band&& bandOf, F&& f) {
+        std::size_t visited = 0;
+        for (auto& [key, block] : blocks) {
+            updateLods(*block, 0, 0, 0, bandOf, f, visited);
+        }
+        return visited;
+    }
+    
+    // Replaces visible with the chunks whose bounds intersect the frustum.
+    // Subtrees wholly inside or outside are decided by their node; the
+    // leaves of partly visible nodes just above them are tested in one
+    // PackedBounds batch. Returns the nodes tested.
+    std::size_t cull(const Frustum& frustum, std::vector<Chunk>& visible) {
+        visible.clear();
+        boundary.clear();
+        boundaryChunks.clear();
+        std::size_t tested = 0;
+        for (auto& [key, block] : blocks) {
+            cull(*block, 0, 0, 0, frustum, visible, tested);
+        }
+        boundary.cull(frustum, survivors);
+        for (std::uint32_t survivor : survivors) {
+            visible.push_back(boundaryChunks[survivor]);
+        }
+        return tested + boundary.size();
+    }
+    
+private:
+    struct Node {
+        glm::vec3 boundsMin{0.0f};
+        glm::vec3 boundsMax{0.0f};
+        int count = 0; // Chunks in the subtree
+        int minLod = INT_MAX;
+        int maxLod = INT_MIN;
+    };
+    
+    // Every level's nodes in one array, root first, each level row-major
+    static constexpr std::size_t nodeIndex(int level, int x, int y) {
+        return ((std::size_t(1) << (2 * level)) - 1) / 3 + (static_cast<std::size_t>(y) << level) + x;
+    }
+    
+    struct Block {
+        glm::ivec2 origin; // Coordinate of the chunk at local (0, 0)
+        std::vector<Node> nodes = std::vector<Node>(nodeIndex(LEVELS + 1, 0, 0));
+        std::vector<T> chunks = std::vector<T>(BLOCK_SIZE * BLOCK_SIZE);
+    };
+    
+    std::unordered_map<glm::ivec2, std::unique_ptr<Block>, ChunkHash> blocks;
+    std::size_t count = 0;
+    
+    // cull()'s boundary leaves, kept for their capacity
+    PackedBounds boundary;
+    std::vector<Chunk> boundaryChunks;
+    std::vector<std::uint32_t> survivors;
+    
+    // Arithmetic shifts round towards negative infinity
+    static glm::ivec2 blockOf(glm::ivec2 coord) { return glm::ivec2(coord.x >> LEVELS, coord.y >> LEVELS); }
+    static std::size_t leafIndex(glm::ivec2 local) { return static_cast<std::size_t>(local.y) * BLOCK_SIZE + local.x; }
+    
+    // Chunk coordinates covered by a node
+    static glm::ivec2 rectMin(const Block& block, int level, int x, int y) {
+        return block.origin + glm::ivec2(x << (LEVELS - level), y << (LEVELS - level));
+    }
+    static glm::ivec2 rectMax(const Block& block, int level, int x, int y) {
+        return rectMin(block, level, x, y) + glm::ivec2((1 << (LEVELS - level)) - 1);
+    }
+    static bool insideWindow(glm::ivec2 low, glm::ivec2 high, glm::ivec2 windowMin, glm::ivec2 windowMax) {
+        return low.x >= windowMin.x && low.y >= windowMin.y && high.x <= windowMax.x && high.y <= windowMax.y;
+    }
+    
+    void refitNode(Block& block, int level, int x, int y) {
+        Node& node = block.nodes[nodeIndex(level, x, y)];
+        node = Node{};
+        if (level == LEVELS) {
+            const T& chunk = block.chunks[leafIndex(glm::ivec2(x, y))];
+            if (chunk) {
+                node.boundsMin = chunk->getBoundsMin();
+                node.boundsMax = chunk->getBoundsMax();
+                node.count = 1;
+                node.minLod = node.maxLod = chunk->getLOD();
+            }
+            return;
+        }
+        for (int child = 0; child < 4; ++child) {
+            const Node& from = block.nodes[nodeIndex(level + 1, 2 * x + (child & 1), 2 * y + (child >> 1))];
+            if (from.count == 0) {
+                continue;
+            }
+            node.boundsMin = node.count == 0 ? from.boundsMin : glm::min(node.boundsMin, from.boundsMin);
+            node.boundsMax = node.count == 0 ? from.boundsMax : glm::max(node.boundsMax, from.boundsMax);
+            node.count += from.count;
+            node.minLod = std::min(node.minLod, from.minLod);
+            node.maxLod = std::max(node.maxLod, from.maxLod);
+        }
+    }
+    
+    void refitPath(Block& block, glm::ivec2 local) {
+        for (int level = LEVELS; level >= 0; --level) {
+            refitNode(block, level, local.x >> (LEVELS - level), local.y >> (LEVELS - level));
+        }
+    }
+    
+    template <typename F>
+    void removeOutside(Block& block, int level, int x, int y, glm::ivec2 windowMin, glm::ivec2 windowMax, F& take) {
+        if (block.nodes[nodeIndex(level, x, y)].count == 0 ||
+            insideWindow(rectMin(block, level, x, y), rectMax(block, level, x, y), windowMin, windowMax)) {
+            return;
+        }
+        if (level == LEVELS) {
+            T& chunk = block.chunks[leafIndex(glm::ivec2(x, y))];
+            take(block.origin + glm::ivec2(x, y), std::move(chunk));
+            chunk = T{};
+            count--;
+        } else {
+            for (int child = 0; child < 4; ++child) {
+                removeOutside(block, level + 1, 2 * x + (child & 1), 2 * y + (child >> 1), windowMin, windowMax, take);
+            }
+        }
+        refitNode(block, level, x, y);
+    }
+    
+    template <typename F>
+    void forEachMissing(const Block& block, int level, int x, int y, glm::ivec2 windowMin, glm::ivec2 windowMax, F& f) const {
+        glm::ivec2 low = rectMin(block, level, x, y);
+        glm::ivec2 high = rectMax(block, level, x, y);
+        if (high.x < windowMin.x || high.y < windowMin.y || low.x > windowMax.x || low.y > windowMax.y) {
+            return;
+        }
+        const int side = 1 << (LEVELS - level);
+        const int chunks = block.nodes[nodeIndex(level, x, y)].count;
+        if (chunks == side * side) {
+            return;
+        }
+        if (level == LEVELS) {
+            f(low);
+            return;
+        }
+        for (int child = 0; child < 4; ++child) {
+            forEachMissing(block, level + 1, 2 * x + (child & 1), 2 * y + (child >> 1), windowMin, windowMax, f);
+        }
+    }
+    
+    template <typename Band, typename F>
+    void updateLods(Block& block, int level, int x, int y, Band& bandOf, F& f, std::size_t& visited) {
+        const Node& node = block.nodes[nodeIndex(level, x, y)];
+        if (node.count == 0) {
+            return;
+        }
+        visited++;
+        int band = bandOf(rectMin(block, level, x, y), rectMax(block, level, x, y));
+        if (band >= 0 && node.minLod == band && node.maxLod == band) {
+            return;
+        }
+        if (level == LEVELS) {
+            f(block.origin + glm::ivec2(x, y), block.chunks[leafIndex(glm::ivec2(x, y))]);
+        } else {
+            for (int child = 0; child < 4; ++child) {
+                updateLods(block, level + 1, 2 * x + (child & 1), 2 * y + (child >> 1), bandOf, f, visited);
+            }
+        }
+        refitNode(block, level, x, y);
+    }
+    
+    void cull(Block& block, int level, int x, int y, const Frustum& frustum, std::vector<Chunk>& visible, std::size_t& tested) {
+        const Node& node = block.nodes[nodeIndex(level, x, y)];
+        if (node.count == 0) {
+            return;
+        }
+        tested++;
+        if (!frustum.intersects(node.boundsMin, node.boundsMax)) {
+            return;
+        }
+        
+        // Everything under a node inside the frustum is visible, and the
+        // chunks are stored row by row, so this needs no more nodes
+        const int side = 1 << (LEVELS - level);
+        if (level == LEVELS || frustum.contains(node.boundsMin, node.boundsMax)) {
+            for (int row = y * side; row < (y + 1) * side; ++row) {
+                for (int column = x * side; column < (x + 1) * side; ++column) {
+                    T& chunk = block.chunks[leafIndex(glm::ivec2(column, row))];
+                    if (chunk) {
+                        visible.push_back(&*chunk);
+                    }
+                }
+            }
+            return;
+        }
+        if (level + 1 == LEVELS) {
+            for (int child = 0; child < 4; ++child) {
+                T& chunk = block.chunks[leafIndex(glm::ivec2(2 * x + (child & 1), 2 * y + (child >> 1)))];
+                if (chunk) {
+                    boundary.add(chunk->getBoundsMin(), chunk->getBoundsMax());
+                    boundaryChunks.push_back(&*chunk);
+                }
+            }
+            return;
+        }
+        for (int child = 0; child < 4; ++child) {
+            cull(block, level + 1, 2 * x + (child & 1), 2 * y + (child >> 1), frustum, visible, tested);
+        }
+    }
+};
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "Perlin.h"
+
+// Temperature and moisture at a point, with their world-space gradients
+struct ClimateSample {
+    float temperature;
+    float moisture;
+    glm::vec2 temperatureGradient; // (d/dx, d/dz)
+    glm::vec2 moistureGradient;
+};
+
+// Blend weights of the biomes that contribute at one point, largest first.
+// Weights of the first count entries sum to 1.
+struct BiomeWeights {
+    static constexpr int MAX_BIOMES = 4;
+    
+    int count;
+    int biomes[MAX_BIOMES];
+    float weights[MAX_BIOMES];
+};
+
+// Low-resolution cache of the biome climate fields. Temperature and
+// moisture vary on a ~500 unit scale, so they are sampled once per
+// CELL_SIZE units in square tiles and bilinearly interpolated in between.
+// Nodes sit on a fixed world lattice, so values are deterministic per seed
+// and independent of which tiles happen to be cached.
+//
+// Each tile also classifies its nodes into biomes and stores, per biome,
+// a weight that falls off linearly with distance to that biome's region
+// (an exact Euclidean distance transform over the tile plus an apron wide
+// enough to see every region within BLEND_DISTANCE). Any number of biomes
+// can then be blended at a sample with one bilinear lookup per biome.
+class ClimateRaster {
+public:
+    // Maps (temperature, moisture) to a biome id in [0, biomeCount)
+    using Classifier = std::function<int(float temperature, float moisture)>;
+    
+    static constexpr float CELL_SIZE = 8.0f;
+    static constexpr int TILE_CELLS = 64;
+    static constexpr std::size_t MAX_TILES = 256;
+    static constexpr float BLEND_DISTANCE = 50.0f;
+    
+    ClimateRaster(unsigned int seed, int biomeCount, Classifier classifier);
+    
+    ClimateSample sample(float x, float z) const;
+    BiomeWeights sampleWeights(float x, float z) const;
+    
+    // Exact (unrasterized) climate fields, as used to fill the tiles
+    float temperatureAt(float x, float z) const;
+    float moistureAt(float x, float z) const;
+    
+    int getBiomeCount() const { return biomeCount; }
+    std::size_t tileCount() const;
+    
+private:
+    // Cells of apron around a tile for the distance transform
+    static constexpr int APRON_CELLS = static_cast<int>(BLEND_DISTANCE / CELL_SIZE) + 2;
+    
+    // (TILE_CELLS + 1)^2 nodes per field, row-major; the last row and column
+    // duplicate the first of the neighbouring tile so lookups stay in one tile.
+    // weights holds one such plane per biome, quantized to 0..255.
+    struct Tile {
+        std::vector<float> temperature;
+        std::vector<float> moisture;
+        std::vector<std::uint8_t> weights;
+    };
+    
+    struct TileHash {
+        std::size_t operator()(const glm::ivec2& k) const {
+            return std::hash<int>()(k.x) ^ (std::hash<int>()(k.y) << 1);
+        }
+    };
+    
+    // Tile holding a point, the node at the cell's lower corner and the
+    // offsets into the cell
+    struct Lookup {
+        std::shared_ptr<const Tile> tile;
+        int node;
+        float fx;
+        float fz;
+    };
+    
+    PerlinNoise noise;
+    int biomeCount;
+    Classifier classifier;
+    
+    // Tiles are immutable once built; shared ownership lets a reader keep
+    // using a tile that gets evicted under it
+    mutable std::mutex tileMutex;
+    mutable std::unordered_map<glm::ivec2, std::shared_ptr<const Tile>, TileHash> tiles;
+    mutable std::deque<glm::ivec2> tileOrder; // Oldest first, for eviction
+    
+    Lookup locate(float x, float z) const;
+    std::shared_ptr<const Tile> getTile(glm::ivec2 tile) const;
+    std::shared_ptr<const Tile> buildTile(glm::ivec2 tile) const;
+};
@@ -3,6 +3,11 @@
 #include <string>
 #include <glm/glm.hpp>
 #include "Json.hpp"
+#include "VertexFormat.h"
+#include "GridIndices.h"
+#include "Heightfield.h"
+#include "LodMorph.h"
+#include "AdaptiveMesh.h"
 
 using json = nlohmann::json;
 
@@ -46,7 +51,17 @@ struct TerrainConfig {
     std::vector<float> lodDistances;
     unsigned int heightNoiseSeed;
     unsigned int biomeNoiseSeed;
-    int maxChunkPoolSize;
+    VertexFormat vertexFormat; // "full", "compact" or "heightTile"
+    IndexEncoding indexEncoding; // "triangles" or "strips"
+    bool keepCpuMeshes;          // Debug: keep chunk vertices in RAM after upload
+    NormalSource normalSource;   // "analytic" or "heightfield"
+    LodMode lodMode;             // "discrete" or "morph"
+    float lodMorphRegion;        // Fraction of each LOD band spent morphing
+    MeshMode meshMode;           // "grid" or "adaptive"
+    float adaptiveMaxError;      // World units an adaptive mesh may deviate from its grid
+    int uploadRingMegabytes;     // Staging ring for chunk vertex uploads
+    int chunkArenaMegabytes;     // Starting size of the shared chunk vertex buffer, which grows as needed
+    bool horizonCulling;         // Skip chunks hidden behind nearer terrain in camera passes
 };
 
 struct BiomeConfig {
@@ -57,6 +72,8 @@ struct BiomeConfig {
     glm::vec3 peakColor;
     float colorThreshold1;
     float colorThreshold2;
+    glm::vec2 climate;   // (temperature, moisture) center; samples take the nearest biome
+    std::string feature; // "none", "dunes" or "peaks"
 };
 
 struct WaterConfig {
@@ -126,6 +143,7 @@ private:
     
     Config() = default;
     
+    glm::vec2 parseVec2(const json& arr);
     glm::vec3 parseVec3(const json& arr);
     
 public:
@@ -1,42 +1,121 @@
 #pragma once
 
-#include <unordered_map>
+#include <exception>
 #include <memory>
-#include <queue>
+#include <optional>
+#include <unordered_set>
 #include <glm/glm.hpp>
 #include "TerrainChunk.h"
+#include "ChunkIndexCache.h"
+#include "HeightTileStore.h"
+#include "GeometryUploadRing.h"
+#include "ChunkArena.h"
+#include "ChunkQuadtree.h"
+#include "HorizonCuller.h"
+#include "MeshScratch.h"
+#include "WorkerPool.h"
 #include "Shader.h"
 #include "Perlin.h"
 #include "Biome.h"
 #include "Config.h"
 
-struct ChunkHash {
-    std::size_t operator()(const glm::ivec2& k) const {
-        return std::hash<int>()(k.x) ^ (std::hash<int>()(k.y) << 1);
-    }
+// Geometry held by the loaded chunks. Vertex and index bytes are on the
+// GPU; the CPU side is only the generation scratch plus any debug copies.
+struct TerrainMemoryStats {
+    VertexFormat vertexFormat;
+    std::size_t chunks = 0;
+    std::size_t vertices = 0;
+    std::size_t vertexBytes = 0;
+    std::size_t indexBytes = 0;      // Shared per-LOD buffers
+    std::size_t fullVertexBytes = 0; // vertexBytes had the chunks used VertexFormat::FULL
+    std::size_t scratchBytes = 0;    // Idle MeshScratchPool capacity
+    std::size_t retainedBytes = 0;   // terrain.keepCpuMeshes debug copies
+    std::size_t tileArrayBytes = 0;  // HeightTileStore layers, used or free
+    std::size_t uploadRingBytes = 0; // GeometryUploadRing staging, mapped or in RAM
+    std::size_t arenaBytes = 0;      // ChunkArena vertex and element buffers
+    std::size_t arenaUsedBytes = 0;
+    std::size_t adaptiveBytes = 0;   // MeshMode::ADAPTIVE heights and error maps
+    std::size_t triangles = 0;       // Before edge stitching folds any away
+    std::size_t gridTriangles = 0;   // triangles had every chunk used its full LOD grid
+    float maxMeshError = 0.0f;       // Worst TerrainChunk::getMeshError()
 };
 
 class DynamicTerrain {
 private:
+    // Declared before the chunks, which release their tiles into it
+    std::unique_ptr<HeightTileStore> heightTiles;
+    std::vector<HeightTileStore::Instance> tileInstances;
+    std::unique_ptr<GeometryUploadRing> uploadRing; // Likewise outlives the chunks staging into it
+    std::unique_ptr<ChunkArena> arena;              // and the chunks holding ranges of it
+    std::vector<ChunkArena::Draw> chunkDraws;
+    int drawnChunks = 0; // In the last render() pass
+    int drawCalls = 0;
+    int culledChunks = 0;
+    std::size_t cullTests = 0; // Quadtree nodes and boundary chunks
+    std::size_t lodNodes = 0;  // Quadtree nodes the last LOD update visited
+    std::vector<TerrainChunk*> visibleChunks;
+    bool horizonCulling;
+    HorizonCuller horizonCuller;
+    int occludedChunks = 0; // In the frustum but behind nearer terrain
     
-    std::unordered_map<glm::ivec2, std::unique_ptr<TerrainChunk>, ChunkHash> chunks;
-    std::queue<std::unique_ptr<TerrainChunk>> chunkPool;
+    // Each render() pass culls this against its own view-projection
+    ChunkQuadtree<std::unique_ptr<TerrainChunk>> chunks;
+    std::vector<glm::ivec2> dirtyChunks; // Added, removed or changed LOD; their neighbours restitch
     
     std::unique_ptr<PerlinNoise> heightNoise;
     std::unique_ptr<BiomeGenerator> biomeGen;
+    std::unique_ptr<ChunkIndexCache> indexCache;
+    MeshScratchPool scratchPool;
     
     glm::ivec2 lastPlayerChunk;
+    glm::vec3 lodCenter; // Position chunk LODs were last chosen for
+    ChunkMeshOptions meshOptions;
+    LodMode lodMode;
+    std::vector<LodMorphRange> morphRanges; // Per LOD
+    
+    // Under performance.multiThreadedChunkGeneration, chunks are built on
+    // buildPool and only uploaded here. A chunk changing LOD is rebuilt as
+    // a new chunk and keeps drawing until that replacement lands.
+    struct ChunkBuild {
+        glm::ivec2 coord;
+        std::unique_ptr<TerrainChunk> chunk;
+        std::unique_ptr<MeshScratch> scratch;
+        std::exception_ptr failure; // What build() threw; the chunk is then dropped
+    };
+    std::vector<glm::ivec2> buildQueue; // Not yet submitted, nearest last
+    bool buildQueueSorted = true;
+    std::unordered_set<glm::ivec2, ChunkHash> queuedBuilds;
+    std::unordered_set<glm::ivec2, ChunkHash> runningBuilds; // Submitted and not yet landed
+    std::size_t maxRunningBuilds = 0;                         // Bounds the scratches in use
+    std::vector<ChunkBuild> finishedBuilds;
+    std::size_t landedBuilds = 0;
     
     void updateChunks(const glm::vec3& playerPos, const glm::mat4& viewProjection);
+    void updateLods(const glm::vec3& playerPos); // Adds the chunks that changed LOD to dirtyChunks
+    void stitchChunks();                         // Around dirtyChunks, which it clears
     int calculateLOD(float distance) const;
     int getNeighborLOD(const glm::ivec2& coord) const;
-    std::unique_ptr<TerrainChunk> getOrCreateChunk(const glm::ivec2& coord);
+    std::unique_ptr<TerrainChunk> createChunk(const glm::ivec2& coord);
+    bool inWindow(const glm::ivec2& coord) const; // Around lastPlayerChunk
+    void requestBuild(const glm::ivec2& coord);
+    void submitBuilds(const glm::vec3& playerPos);
+    void collectBuilds(const glm::vec3& playerPos, bool wait); // With wait, until nothing is queued or running
+    
+    // Last, so it is gone before anything its jobs use
+    std::unique_ptr<WorkerPool<ChunkBuild>> buildPool;
     
 public:
     DynamicTerrain();
     
     void update(const glm::vec3& playerPos, const glm::mat4& viewProjection);
-    void render(Shader& shader, Shader& shadowShader, const glm::mat4& lightSpaceMatrix, const glm::mat4& viewProjection = glm::mat4(1.0f));
+    // Chunks outside viewProjection's frustum are skipped; for the shadow
+    // pass that is the light's matrix. Given the eye, so are chunks hidden
+    // behind nearer terrain, which only holds if all of it is drawn.
+    void render(Shader& shader, Shader& shadowShader, const glm::mat4& lightSpaceMatrix, const glm::mat4& viewProjection,
+                std::optional<glm::vec3> occlusionEye = std::nullopt);
     float getHeightAt(float x, float z) const;
     glm::vec3 getColorAt(float x, float z, float height) const;
+    
+    TerrainMemoryStats getMemoryStats() const;
+    void printMemoryReport() const;
 };
\ No newline at end of file
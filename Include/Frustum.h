@@ -0,0 +1,39 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// The six clip planes of a view-projection matrix, normals pointing inwards
+// and normalized, so dot(plane, vec4(p, 1)) is p's signed distance
+struct Frustum {
+    std::array<glm::vec4, 6> planes; // Left, right, bottom, top, near, far
+    
+    static Frustum fromMatrix(const glm::mat4& viewProjection);
+    
+    // Conservative: false only when the box is wholly behind one plane
+    bool intersects(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+    
+    // True when the whole box is in front of every plane
+    bool contains(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+};
+
+// Axis-aligned boxes stored as structure of arrays, so a whole set is
+// culled in one pass, four boxes per SSE iteration
+class PackedBounds {
+public:
+    void clear();
+    void reserve(std::size_t count);
+    std::size_t add(const glm::vec3& boundsMin, const glm::vec3& boundsMax); // Returns the box's index
+    std::size_t size() const { return minX.size(); }
+    
+    // Replaces visible with the indices, in order, of the boxes that
+    // Frustum::intersects accepts; every lane gives the scalar answer
+    void cull(const Frustum& frustum, std::vector<std::uint32_t>& visible) const;
+    
+private:
+    std::vector<float> minX, minY, minZ;
+    std::vector<float> maxX, maxY, maxZ;
+};
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// Staging memory for geometry on its way to the GPU. Mesh generation writes
+// vertices straight into an allocation, which copyTo() then moves into the
+// chunk's own buffer on the GPU side, so the driver never copies them.
+//
+// With ARB_buffer_storage the ring is one persistently mapped, coherent
+// buffer; a region is only handed out again once the fence inserted by the
+// endFrame() after its copies has signalled. Without it the ring is plain
+// memory and copyTo() falls back to glBufferSubData.
+class GeometryUploadRing {
+public:
+    // A sub-range of the ring, valid until the next allocate() or endFrame()
+    struct Allocation {
+        void* data = nullptr;
+        std::size_t offset = 0;
+        std::size_t size = 0;
+    };
+    
+    explicit GeometryUploadRing(std::size_t capacity);
+    ~GeometryUploadRing();
+    
+    // Waits for the GPU if the region it reuses is still being read
+    Allocation allocate(std::size_t size);
+    
+    // Copies the allocation to target at targetOffset; target must have room
+    void copyTo(const Allocation& allocation, GLuint target, std::size_t targetOffset = 0);
+    
+    // Fences everything copied since the last call
+    void endFrame();
+    
+    bool isPersistent() const { return mapped != nullptr; }
+    std::size_t getCapacity() const { return capacity; }
+    std::size_t getStreamedBytes() const { return head; } // Skipped ring tails included
+    std::size_t getStallCount() const { return stalls; }
+    
+    GeometryUploadRing(const GeometryUploadRing&) = delete;
+    GeometryUploadRing& operator=(const GeometryUploadRing&) = delete;
+    
+private:
+    // Ring positions count up forever; position p lives at p % capacity
+    struct Fence {
+        GLsync sync;
+        std::size_t end; // Everything before this position
+    };
+    
+    std::size_t capacity;
+    GLuint buffer;
+    std::byte* mapped;             // Persistent mapping, or nullptr for the fallback
+    std::vector<std::byte> memory; // Fallback storage
+    std::size_t head;
+    std::size_t fencedHead;  // Copies before this are fenced
+    std::size_t retiredHead; // and before this known to be done
+    std::deque<Fence> fences;
+    std::size_t stalls;
+    
+    void fence();
+    void waitUntilFree(std::size_t position);
+};
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Index lists for a chunk's regular vertexResolution x vertexResolution
+// grid, where vertex z * vertexResolution + x sits at column x, row z.
+// They depend only on the resolution, so ChunkIndexCache builds each once.
+
+// Chunk index layouts, selected by terrain.indexEncoding in config.json
+enum class IndexEncoding {
+    TRIANGLES, // 32-bit GL_TRIANGLES lists
+    STRIPS     // One GL_TRIANGLE_STRIP per row joined by primitive restart,
+               // 16-bit whenever the grid fits
+};
+
+IndexEncoding parseIndexEncoding(const std::string& name);
+const char* indexEncodingName(IndexEncoding encoding);
+
+// Grid sides that border a chunk one LOD coarser. North is row z = 0
+// (towards -Z), west is column x = 0 (towards -X).
+enum ChunkEdge : unsigned int {
+    EDGE_NORTH = 1 << 0,
+    EDGE_SOUTH = 1 << 1,
+    EDGE_EAST = 1 << 2,
+    EDGE_WEST = 1 << 3
+};
+constexpr unsigned int EDGE_MASK_COUNT = 16;
+
+// Grid resolution at a LOD: every level halves the cells, down to 2x2
+// vertices. With 2^n + 1 vertices each level's grid is a subset of the
+// previous one, which edge stitching and LOD morphing rely on.
+int lodVertexResolution(int resolution, int lod);
+
+// Stitching halves an edge, so it needs an even number of cells
+bool canStitchEdges(int vertexResolution);
+
+// Two counter-clockwise (seen from +Y) triangles per grid cell. Along each
+// edge in stitchedEdges, every odd vertex is folded onto its even
+// predecessor so the edge follows the coarser neighbour's vertices exactly;
+// the triangles that collapse are left out. With both south and east
+// stitched, the corner cell is split along its other diagonal.
+std::vector<unsigned int> buildGridTriangles(int vertexResolution, unsigned int stitchedEdges = 0);
+
+// The same triangles as strips, one per row of cells, separated by
+// restartIndex. Each row alternates between rows z and z + 1 so the strip
+// triangles match buildGridTriangles() including winding. Stitched edges
+// keep their collapsed triangles, which GL skips, so the strip parity holds.
+// With bandCells > 0 the grid is drawn in columns of that many cells, each
+// top to bottom, so a row's vertices are still in the vertex cache when the
+// next row reuses them.
+std::vector<unsigned int> buildGridStrips(int vertexResolution, unsigned int restartIndex, unsigned int stitchedEdges = 0,
+                                          int bandCells = 0);
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "VertexFormat.h"
+#include "ChunkIndexCache.h"
+#include "LodMorph.h"
+#include "Shader.h"
+
+// Storage and drawing for VertexFormat::HEIGHT_TILE chunks. Each chunk's
+// vertices live as one layer of a GL_RGB16UI texture array sized for its
+// LOD, and all chunks are drawn from the shared ChunkIndexCache grids with
+// no vertex buffer: terrain.vert takes the grid position from gl_VertexID
+// and everything else from the tile.
+class HeightTileStore {
+public:
+    // Where a chunk's tile lives; page is an array within the LOD
+    struct Slot {
+        int lod = -1;
+        int page = -1;
+        int layer = -1;
+        
+        bool valid() const { return page >= 0; }
+    };
+    
+    // Everything render() needs to draw one chunk
+    struct Instance {
+        Slot slot;
+        unsigned int stitchedEdges; // Picks the ChunkIndexCache variant
+        unsigned int pinnedEdges;   // Edges that must not morph
+        float originX;
+        float originZ;
+        HeightQuantization heightQuantization;
+    };
+    
+    HeightTileStore(int resolution, float chunkSize, int lodLevels);
+    ~HeightTileStore();
+    
+    Slot allocate(int lod);
+    void release(Slot& slot);
+    
+    // texels is the LOD's vertexResolution^2 grid, row-major
+    void upload(const Slot& slot, std::span<const HeightTileTexel> texels);
+    
+    // One instanced draw per LOD, array page and stitched edge mask. The
+    // tile arrays go to textureUnit; morphRanges is per LOD, empty to
+    // disable morphing. Returns the number of draw calls.
+    int render(const Shader& shader, std::span<const Instance> instances, const ChunkIndexCache& indexCache,
+                const std::vector<LodMorphRange>& morphRanges, int textureUnit);
+    
+    // Allocated array layers, used or not
+    std::size_t getBytes() const;
+    
+    HeightTileStore(const HeightTileStore&) = delete;
+    HeightTileStore& operator=(const HeightTileStore&) = delete;
+    
+private:
+    struct Page {
+        GLuint texture;
+        int layers;
+        std::vector<int> freeLayers;
+    };
+    
+    int resolution;
+    float chunkSize;
+    int maxLayers;
+    std::vector<std::vector<Page>> pages; // Per LOD
+    GLuint VAO;
+    GLuint instanceBuffer;
+    std::vector<Instance> sorted;
+    std::vector<ChunkAttributes> gpuInstances; // Locations 7-9 in terrain.vert
+};
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <glm/glm.hpp>
+
+// Where chunk vertex normals come from, selected by terrain.normalSource
+enum class NormalSource {
+    ANALYTIC,   // Blended noise gradient from BiomeGenerator::sampleGrid
+    HEIGHTFIELD // Central differences over the generated heights
+};
+
+NormalSource parseNormalSource(const std::string& name);
+const char* normalSourceName(NormalSource source);
+
+// Normals of a heightfield by central differences. heights is row-major
+// xs.size() x zs.size() and includes a one-sample apron ring, so out
+// receives the (xs.size() - 2) x (zs.size() - 2) interior normals. The
+// axes may be unevenly spaced. Results do not depend on a vertex's position
+// in the row, so two chunks that sample the same neighbourhood for a shared
+// edge vertex get bit-identical normals.
+void heightfieldNormals(std::span<const float> heights, std::span<const float> xs, std::span<const float> zs,
+                        std::span<glm::vec3> out);
\ No newline at end of file
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Conservative occlusion culling of terrain by terrain nearer the eye. The
+// horizon is a 1D buffer over the full circle of azimuths, holding per bin
+// the steepest elevation slope (height over horizontal distance) below which
+// every line of sight is already blocked. Bins are even steps of a diamond
+// angle rather than of the angle itself; both go round in the same order.
+//
+// Occluders raise it with a floor height: the terrain over their footprint
+// never goes below it, so a line of sight crossing the footprint under that
+// floor hits the ground. Only bins the footprint covers completely are
+// raised. An occludee is hidden when even the top of its box is below the
+// horizon in every bin its footprint touches.
+//
+// Along any line of sight, an occluder only hides what lies beyond it, so
+// the work goes outwards in rings that every line of sight crosses in order:
+// Chebyshev rings of chunks around the eye's chunk. Each ring is tested,
+// adds its occluders, and only then hides anything, through commit().
+class HorizonCuller {
+public:
+    explicit HorizonCuller(int bins = 2048);
+    
+    // Clears the horizon for a new eye position
+    void begin(const glm::vec3& eye);
+    
+    // Footprints are axis-aligned rectangles in the xz plane. Ones that
+    // contain the eye are never hidden and never occlude.
+    bool isHidden(const glm::vec2& footprintMin, const glm::vec2& footprintMax, float maxHeight) const;
+    void addOccluder(const glm::vec2& footprintMin, const glm::vec2& footprintMax, float floorHeight);
+    void commit(); // Occluders added since the last commit() start hiding
+    
+    // Drops the chunks hidden from eye, a grid of chunkSize squares with
+    // getBoundsMin() and getBoundsMax(), each of which occludes down to its
+    // bounds' floor. The rest are left front to back, ring by ring.
+    // Returns how many were dropped.
+    template <typename Chunk>
+    std::size_t cull(const glm::vec3& eye, float chunkSize, std::vector<Chunk*>& chunks);
+    
+    int getBinCount() const { return static_cast<int>(horizon.size()); }
+    
+private:
+    glm::vec3 eye;
+    std::vector<float> horizon; // Committed slopes per bin
+    std::vector<float> pending; // Raised by addOccluder() until commit()
+    std::vector<int> touched;   // Bins pending differs from horizon in
+    std::vector<std::uint32_t> ringStarts; // cull()'s counting sort
+    std::vector<std::uint32_t> ringOrder;
+    
+    // A footprint seen from the eye: the bins it spans, which may run past
+    // the last one, and its nearest and furthest horizontal distances
+    struct Footprint {
+        double firstBin;
+        double lastBin;
+        float nearest;
+        float furthest;
+    };
+    bool project(const glm::vec2& footprintMin, const glm::vec2& footprintMax, Footprint& footprint) const; // False if it holds the eye
+    bool hidden(const Footprint& footprint, float maxHeight) const;
+    void raise(const Footprint& footprint, float floorHeight);
+};
+
+template <typename Chunk>
+std::size_t HorizonCuller::cull(const glm::vec3& eye, float chunkSize, std::vector<Chunk*>& chunks) {
+    begin(eye);
+    
+    // Chunks by ring, with a counting sort; the input is in no useful order
+    const glm::ivec2 eyeChunk(static_cast<int>(std::floor(eye.x / chunkSize)), static_cast<int>(std::floor(eye.z / chunkSize)));
+    auto ringOf = [&](const Chunk* chunk) {
+        glm::vec3 center = 0.5f * (chunk->getBoundsMin() + chunk->getBoundsMax());
+        int x = static_cast<int>(std::floor(center.x / chunkSize)) - eyeChunk.x;
+        int z = static_cast<int>(std::floor(center.z / chunkSize)) - eyeChunk.y;
+        return static_cast<std::size_t>(std::max(std::abs(x), std::abs(z)));
+    };
+    ringStarts.assign(1, 0);
+    for (const Chunk* chunk : chunks) {
+        std::size_t ring = ringOf(chunk);
+        if (ring + 2 > ringStarts.size()) {
+            ringStarts.resize(ring + 2, 0);
+        }
+        ringStarts[ring + 1]++;
+    }
+    for (std::size_t ring = 1; ring < ringStarts.size(); ++ring) {
+        ringStarts[ring] += ringStarts[ring - 1];
+    }
+    ringOrder.resize(chunks.size());
+    for (std::uint32_t i = 0; i < chunks.size(); ++i) {
+        ringOrder[ringStarts[ringOf(chunks[i])]++] = i;
+    }
+    
+    // ringStarts now holds each ring's end. Hidden chunks would not raise
+    // the horizon: their tops are already below it.
+    std::vector<Chunk*> sorted(ringOrder.size());
+    std::size_t kept = 0;
+    std::size_t ringBegin = 0;
+    for (std::size_t ringEnd : ringStarts) {
+        for (std::size_t i = ringBegin; i < ringEnd; ++i) {
+            Chunk* chunk = chunks[ringOrder[i]];
+            glm::vec3 boundsMin = chunk->getBoundsMin();
+            glm::vec3 boundsMax = chunk->getBoundsMax();
+            Footprint footprint;
+            if (!project(glm::vec2(boundsMin.x, boundsMin.z), glm::vec2(boundsMax.x, boundsMax.z), footprint)) {
+                sorted[kept++] = chunk;
+            } else if (!hidden(footprint, boundsMax.y)) {
+                sorted[kept++] = chunk;
+                raise(footprint, boundsMin.y);
+            }
+        }
+        commit();
+        ringBegin = ringEnd;
+    }
+    sorted.resize(kept);
+    std::size_t dropped = chunks.size() - kept;
+    chunks.swap(sorted);
+    return dropped;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// How chunks change detail with distance, selected by terrain.lodMode
+enum class LodMode {
+    DISCRETE, // Chunks switch LOD when their centre crosses a lodDistances entry
+    MORPH     // CDLOD-style: odd vertices slide onto the next LOD's grid in
+              // terrain.vert before the switch, so nothing pops
+};
+
+LodMode parseLodMode(const std::string& name);
+const char* lodModeName(LodMode mode);
+
+// LOD for a chunk whose centre is distance away: the first lodDistances
+// entry it is closer than, otherwise the coarsest level
+int selectLod(const std::vector<float>& lodDistances, int maxLodLevels, float distance);
+
+// Distances over which a chunk at lod morphs towards lod + 1, measured from
+// the LOD centre to a vertex at height 0. Chunks switch on their centre
+// distance while vertices morph on their own, so the range is pulled in by
+// half a chunk diagonal at both ends: every vertex is fully morphed when
+// the chunk switches to lod + 1, and none has started when it switches in
+// from lod - 1. morphRegion is the fraction of the band to use at most.
+struct LodMorphRange {
+    float start = 0.0f;
+    float end = 0.0f;
+    
+    bool morphs() const { return end > start; }
+};
+
+LodMorphRange lodMorphRange(const std::vector<float>& lodDistances, int maxLodLevels, int lod,
+                            float chunkSize, float morphRegion);
+
+// Triangles drawn for the (2 * viewDistance + 1)^2 chunks around position,
+// ignoring the few that edge stitching folds away
+std::size_t viewTriangleCount(const std::vector<float>& lodDistances, int maxLodLevels, int resolution,
+                              float chunkSize, int viewDistance, const glm::vec3& position);
\ No newline at end of file
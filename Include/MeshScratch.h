@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Biome.h"
+#include "VertexFormat.h"
+
+// CPU working set for building one chunk mesh. A chunk fills a scratch,
+// uploads it and hands it back, so no geometry stays resident in RAM once
+// it is on the GPU. The vectors keep their capacity between chunks.
+struct MeshScratch {
+    std::vector<float> worldXs;
+    std::vector<float> worldZs;
+    std::vector<BiomeSample> samples;
+    std::vector<float> heights;
+    std::vector<glm::vec3> normals;
+    std::vector<TerrainVertex> vertices;               // Only for keepCpuMesh or TerrainChunk::build();
+    std::vector<CompactTerrainVertex> compactVertices; // otherwise vertices go to the GeometryUploadRing
+    std::vector<HeightTileTexel> tileTexels;
+    
+    std::size_t capacityBytes() const;
+};
+
+// Free list of scratches owned by the generation side. Safe to share
+// between threads; each generating thread holds its own scratch.
+class MeshScratchPool {
+private:
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<MeshScratch>> available;
+    std::size_t created = 0;
+    
+public:
+    std::unique_ptr<MeshScratch> acquire();
+    void release(std::unique_ptr<MeshScratch> scratch);
+    
+    // Capacity of the scratches currently in the pool
+    std::size_t getBytes() const;
+    std::size_t getCreatedCount() const;
+};
\ No newline at end of file
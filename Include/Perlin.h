@@ -1,36 +1,110 @@
 #pragma once
 
-#include <vector>
+#include <array>
+#include <cstdint>
 #include <cmath>
 #include <random>
+#include <span>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/uniform_int_distribution.hpp>
 
+// Instruction-set paths for the batch evaluator. Scalar is always available;
+// the SIMD paths are picked at runtime from what the host CPU supports.
+enum class NoiseKernel {
+    Scalar,
+    SSE42,
+    AVX2
+};
+
+// Noise value plus its analytic partial derivatives along the two input
+// axes. Terrain callers map (x, y) to world (X, Z), so dx/dy are dN/dX and
+// dN/dZ.
+struct NoiseGradient {
+    float value;
+    float dx;
+    float dy;
+};
+
 class PerlinNoise {
 private:
-    std::vector<int> permutation;
+    // 256 shuffled entries repeated once so lookups never need to wrap. Bytes
+    // rather than ints keep the whole table in 512 bytes of L1.
+    std::array<std::uint8_t, 512> permutation;
     
-    double fade(double t) const {
+    template <typename T>
+    static constexpr T fade(T t) {
         return t * t * t * (t * (t * 6 - 15) + 10);
     }
     
-    double lerp(double t, double a, double b) const {
+    template <typename T>
+    static constexpr T fadeDerivative(T t) {
+        return 30 * t * t * (t * (t - 2) + 1);
+    }
+    
+    template <typename T>
+    static constexpr T lerp(T t, T a, T b) {
         return a + t * (b - a);
     }
     
-    double grad(int hash, double x, double y, double z) const {
+    template <typename T>
+    static constexpr T grad(int hash, T x, T y, T z) {
         int h = hash & 15;
-        double u = h < 8 ? x : y;
-        double v = h < 4 ? y : h == 12 || h == 14 ? x : z;
+        T u = h < 8 ? x : y;
+        T v = h < 4 ? y : h == 12 || h == 14 ? x : z;
         return ((h & 1) == 0 ? u : -u) + ((h & 2) == 0 ? v : -v);
     }
     
+    // grad() on an integer z plane, where the z offset is always zero
+    template <typename T>
+    static constexpr T grad2D(int hash, T x, T y) {
+        return grad(hash, x, y, T(0));
+    }
+    
+    // grad() is linear in its offsets, so its partial derivatives along x
+    // and y only depend on which gradient the hash selects.
+    template <typename T>
+    static constexpr void gradDerivative(int hash, T& gx, T& gy) {
+        int h = hash & 15;
+        T su = (h & 1) == 0 ? T(1) : T(-1);
+        T sv = (h & 2) == 0 ? T(1) : T(-1);
+        gx = T(0);
+        gy = T(0);
+        if (h < 8) gx += su; else gy += su;
+        if (h < 4) gy += sv; else if (h == 12 || h == 14) gx += sv;
+    }
+    
+    // Value and derivatives inside one lattice cell, given its four corner
+    // hashes (AA, BA, AB, BB), the offsets into the cell and the fade weights
+    // along each axis. Shared by the per-point and grid paths so both round
+    // identically.
+    static NoiseGradient blendCellWithGradient(const int hashes[4], float x, float y,
+                                               float u, float v, float du, float dv) {
+        const float n[4] = {
+            grad2D(hashes[0], x, y), grad2D(hashes[1], x - 1, y),
+            grad2D(hashes[2], x, y - 1), grad2D(hashes[3], x - 1, y - 1)
+        };
+        float gx[4], gy[4];
+        for (int i = 0; i < 4; ++i) {
+            gradDerivative(hashes[i], gx[i], gy[i]);
+        }
+        
+        NoiseGradient result;
+        result.value = lerp(v, lerp(u, n[0], n[1]), lerp(u, n[2], n[3]));
+        result.dx = lerp(v, lerp(u, gx[0], gx[1]), lerp(u, gx[2], gx[3]))
+                  + du * lerp(v, n[1] - n[0], n[3] - n[2]);
+        result.dy = lerp(v, lerp(u, gy[0], gy[1]), lerp(u, gy[2], gy[3]))
+                  + dv * (lerp(u, n[2], n[3]) - lerp(u, n[0], n[1]));
+        return result;
+    }
+    
+    template <typename Sample>
+    void evaluateGridImpl(std::span<const float> xs, std::span<const float> ys,
+                          int octaves, float persistence, std::span<Sample> out, int layer) const;
+    
 public:
     PerlinNoise(unsigned int seed = 0) {
-        permutation.resize(256);
-        
         for (int i = 0; i < 256; ++i) {
-            permutation[i] = i;
+            permutation[i] = static_cast<std::uint8_t>(i);
         }
         
         boost::random::mt19937 rng(seed);
@@ -41,7 +115,9 @@ public:
             std::swap(permutation[i], permutation[j]);
         }
         
-        permutation.insert(permutation.end(), permutation.begin(), permutation.end());
+        for (int i = 0; i < 256; ++i) {
+            permutation[256 + i] = permutation[i];
+        }
     }
     
     double noise(double x, double y, double z) const {
@@ -91,4 +167,194 @@ public:
         
         return total / maxValue;
     }
-};
\ No newline at end of file
+    
+    // 2D float path. noise2D(x, y, layer) is the z = layer slice of noise():
+    // with an integer z the fade weight along z is zero, so only the four
+    // corners on that plane contribute. Terrain code only ever samples such
+    // slices, and this does half the lattice work of the 3D path.
+    float noise2D(float x, float y, int layer = 0) const {
+        float fx = std::floor(x);
+        float fy = std::floor(y);
+        int X = static_cast<int>(fx) & 255;
+        int Y = static_cast<int>(fy) & 255;
+        int Z = layer & 255;
+        
+        x -= fx;
+        y -= fy;
+        
+        float u = fade(x);
+        float v = fade(y);
+        
+        int A = permutation[X] + Y;
+        int AA = permutation[A] + Z;
+        int AB = permutation[A + 1] + Z;
+        int B = permutation[X + 1] + Y;
+        int BA = permutation[B] + Z;
+        int BB = permutation[B + 1] + Z;
+        
+        return lerp(v, lerp(u, grad2D(permutation[AA], x, y),
+                               grad2D(permutation[BA], x - 1, y)),
+                       lerp(u, grad2D(permutation[AB], x, y - 1),
+                               grad2D(permutation[BB], x - 1, y - 1)));
+    }
+    
+    // Same value as noise2D(), plus dN/dx and dN/dy from the chain rule
+    // through the fade curves. Costs roughly one extra noise2D() instead of
+    // the four a central-difference gradient would need.
+    NoiseGradient noise2DWithGradient(float x, float y, int layer = 0) const {
+        float fx = std::floor(x);
+        float fy = std::floor(y);
+        int X = static_cast<int>(fx) & 255;
+        int Y = static_cast<int>(fy) & 255;
+        int Z = layer & 255;
+        
+        x -= fx;
+        y -= fy;
+        
+        float u = fade(x);
+        float v = fade(y);
+        float du = fadeDerivative(x);
+        float dv = fadeDerivative(y);
+        
+        int A = permutation[X] + Y;
+        int B = permutation[X + 1] + Y;
+        const int hashes[4] = {
+            permutation[permutation[A] + Z], permutation[permutation[B] + Z],
+            permutation[permutation[A + 1] + Z], permutation[permutation[B + 1] + Z]
+        };
+        return blendCellWithGradient(hashes, x, y, u, v, du, dv);
+    }
+    
+    // octaveNoise() restricted to the z = layer plane. Octave i samples the
+    // z = layer * 2^i slice, exactly as the 3D path scales z.
+    float octaveNoise2D(float x, float y, int octaves, float persistence, int layer = 0) const {
+        if (octaves <= 0) return 0.0f;
+        
+        float total = 0;
+        float frequency = 1;
+        float amplitude = 1;
+        float maxValue = 0;
+        
+        for (int i = 0; i < octaves; ++i) {
+            total += noise2D(x * frequency, y * frequency, layer * (1 << i)) * amplitude;
+            maxValue += amplitude;
+            amplitude *= persistence;
+            frequency *= 2;
+        }
+        
+        return total / maxValue;
+    }
+    
+    // noise2D() at one point on several layers. The cell, offsets, fade
+    // weights and the first two hash levels are shared; only the final
+    // lookup of each corner depends on the layer. out[i] is bit-identical to
+    // noise2D(x, y, layers[i]).
+    void noise2DLayers(float x, float y, std::span<const int> layers, std::span<float> out) const {
+        float fx = std::floor(x);
+        float fy = std::floor(y);
+        int X = static_cast<int>(fx) & 255;
+        int Y = static_cast<int>(fy) & 255;
+        
+        x -= fx;
+        y -= fy;
+        
+        float u = fade(x);
+        float v = fade(y);
+        
+        int A = permutation[X] + Y;
+        int B = permutation[X + 1] + Y;
+        const int corners[4] = {permutation[A], permutation[B], permutation[A + 1], permutation[B + 1]};
+        
+        for (std::size_t i = 0; i < layers.size() && i < out.size(); ++i) {
+            int Z = layers[i] & 255;
+            out[i] = lerp(v, lerp(u, grad2D(permutation[corners[0] + Z], x, y),
+                                     grad2D(permutation[corners[1] + Z], x - 1, y)),
+                             lerp(u, grad2D(permutation[corners[2] + Z], x, y - 1),
+                                     grad2D(permutation[corners[3] + Z], x - 1, y - 1)));
+        }
+    }
+    
+    // Folds per-octave noise values (octave i sampled at frequency 2^i) with
+    // a persistence, exactly as octaveNoise2D() accumulates them. Lets
+    // callers evaluate an octave stack once and weight it several ways.
+    static float combineOctaves(std::span<const float> octaveValues, float persistence) {
+        if (octaveValues.empty()) return 0.0f;
+        
+        float total = 0;
+        float amplitude = 1;
+        float maxValue = 0;
+        
+        for (float value : octaveValues) {
+            total += value * amplitude;
+            maxValue += amplitude;
+            amplitude *= persistence;
+        }
+        
+        return total / maxValue;
+    }
+    
+    // octaveNoise2D() with the gradient accumulated across octaves. The value
+    // matches octaveNoise2D() exactly; each octave's derivative is scaled by
+    // its frequency.
+    NoiseGradient octaveNoise2DWithGradient(float x, float y, int octaves, float persistence, int layer = 0) const {
+        if (octaves <= 0) return {0.0f, 0.0f, 0.0f};
+        
+        NoiseGradient total = {0.0f, 0.0f, 0.0f};
+        float frequency = 1;
+        float amplitude = 1;
+        float maxValue = 0;
+        
+        for (int i = 0; i < octaves; ++i) {
+            NoiseGradient n = noise2DWithGradient(x * frequency, y * frequency, layer * (1 << i));
+            total.value += n.value * amplitude;
+            total.dx += n.dx * amplitude * frequency;
+            total.dy += n.dy * amplitude * frequency;
+            maxValue += amplitude;
+            amplitude *= persistence;
+            frequency *= 2;
+        }
+        
+        total.value /= maxValue;
+        total.dx /= maxValue;
+        total.dy /= maxValue;
+        return total;
+    }
+    
+    // Batch evaluation over structure-of-arrays input:
+    //   out[i] = octaveNoise2D(xs[i], ys[i], octaves, persistence, layer)
+    // The SIMD kernels run the scalar float algorithm lane-wise with the same
+    // operation order, so with the default (non-FMA) build flags they are
+    // bit-identical to octaveNoise2D. BATCH_TOLERANCE bounds the difference
+    // when the scalar path is compiled with FMA contraction. All three spans
+    // must have the same length.
+    static constexpr float BATCH_TOLERANCE = 1e-6f;
+    
+    void octaveNoiseBatch(std::span<const float> xs, std::span<const float> ys,
+                          int octaves, float persistence, std::span<float> out, int layer = 0) const;
+    void octaveNoiseBatch(std::span<const float> xs, std::span<const float> ys,
+                          int octaves, float persistence, std::span<float> out, int layer,
+                          NoiseKernel kernel) const;
+    
+    // Grid evaluation over the outer product of two axes, row-major:
+    //   out[j * xs.size() + i] = octaveNoise2D(xs[i], ys[j], octaves, persistence, layer)
+    // Samples on a regular grid share lattice cells, so cell hashes are only
+    // recomputed when a column or row crosses a cell boundary, and fade
+    // weights are computed once per column and once per row. Results are
+    // bit-identical to the per-point functions. out must hold
+    // xs.size() * ys.size() entries.
+    void evaluateGrid(std::span<const float> xs, std::span<const float> ys,
+                      int octaves, float persistence, std::span<float> out, int layer = 0) const;
+    void evaluateGrid(std::span<const float> xs, std::span<const float> ys,
+                      int octaves, float persistence, std::span<NoiseGradient> out, int layer = 0) const;
+    
+    // Regular grid starting at (originX, originY) with the same step on both
+    // axes; column i samples originX + i * step.
+    void evaluateGrid(float originX, float originY, float step, int width, int height,
+                      int octaves, float persistence, std::span<float> out, int layer = 0) const;
+    void evaluateGrid(float originX, float originY, float step, int width, int height,
+                      int octaves, float persistence, std::span<NoiseGradient> out, int layer = 0) const;
+    
+    static bool isKernelSupported(NoiseKernel kernel);
+    static NoiseKernel bestKernel();
+    static const char* kernelName(NoiseKernel kernel);
+};
@@ -2,37 +2,119 @@
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
+#include <cstddef>
 #include <vector>
 #include <memory>
 #include "Perlin.h"
+#include "Biome.h"
+#include "VertexFormat.h"
+#include "ChunkIndexCache.h"
+#include "MeshScratch.h"
+#include "Heightfield.h"
+#include "LodMorph.h"
+#include "HeightTileStore.h"
+#include "AdaptiveMesh.h"
+#include "GeometryUploadRing.h"
+#include "ChunkArena.h"
+
+// Per-terrain choices for how chunk meshes are built and stored
+struct ChunkMeshOptions {
+    VertexFormat vertexFormat = VertexFormat::FULL;
+    NormalSource normalSource = NormalSource::ANALYTIC;
+    bool keepCpuMesh = false; // Debug: keep a copy of the uploaded vertices
+    HeightTileStore* heightTiles = nullptr; // Required for VertexFormat::HEIGHT_TILE
+    GeometryUploadRing* uploadRing = nullptr; // Required for the vertex buffer formats, with arena
+    ChunkArena* arena = nullptr;
+    MeshMode meshMode = MeshMode::GRID;
+    float adaptiveMaxError = 0.5f; // World units, for MeshMode::ADAPTIVE
+};
 
 class TerrainChunk {
 private:
-    GLuint VAO, VBO, EBO;
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+    ChunkArena* arena;
+    ChunkArena::Handle vertexRange; // This chunk's vertices in the arena
+    ChunkArena::Handle indexRange;  // Its own indices under MeshMode::ADAPTIVE, otherwise NONE
+    HeightTileStore* heightTiles;
+    HeightTileStore::Slot tileSlot; // This chunk's tile for VertexFormat::HEIGHT_TILE
+    GeometryUploadRing* uploadRing;
+    GeometryUploadRing::Allocation stagedVertices; // Written by generateMesh, copied to the arena by uploadMesh
+    VertexFormat vertexFormat;
+    NormalSource normalSource;
+    std::size_t vertexCount;
+    ChunkIndexCache::IndexBuffer drawIndices; // Shared ChunkIndexCache pattern, or the adaptive count and mode
+    unsigned int stitchedEdges;               // ChunkEdge mask drawIndices was chosen for
+    unsigned int pinnedEdges;                 // Edges facing a finer neighbour; they must not morph
+    MeshMode meshMode;
+    float adaptiveMaxError;
+    std::vector<float> adaptiveHeights; // Grid heights and rtinErrors(), kept to
+    std::vector<float> adaptiveErrors;  // rebuild the indices when stitching changes
+    std::size_t triangleCount;
+    float meshError; // Largest distance from the LOD grid's samples to the triangles
+    glm::vec3 boundsMin; // World-space box around the mesh as drawn, for
+    glm::vec3 boundsMax; // DynamicTerrain's frustum culling
+    
+    // Debug only: copies of the uploaded vertices, kept when keepCpuMesh is set
+    bool keepCpuMesh;
+    std::vector<TerrainVertex> keptVertices;
+    std::vector<CompactTerrainVertex> keptCompactVertices;
     glm::ivec2 chunkCoord;
     int resolution;
+    int vertexResolution;
     float chunkSize;
     int lodLevel;
     bool needsUpdate;
+    HeightQuantization heightQuantization;
     
-    void generateMesh(const PerlinNoise& perlin);
-    void generateMeshWithStitching(const PerlinNoise& perlin, int northLOD, int southLOD, int eastLOD, int westLOD);
-    void uploadMesh();
+    void generateMesh(const BiomeGenerator& biomes, const PerlinNoise& perlin, MeshScratch& scratch, bool stage); // stage: into uploadRing
+    void uploadMesh(const MeshScratch& scratch, const ChunkIndexCache::IndexBuffer& indices);
+    ChunkIndexCache::IndexBuffer buildAdaptiveIndices(); // Into indexRange, for the current stitchedEdges
     
 public:
-    TerrainChunk(glm::ivec2 coord, int resolution, float size, int lod = 0);
+    TerrainChunk(glm::ivec2 coord, int resolution, float size, int lod = 0, ChunkMeshOptions options = {});
     ~TerrainChunk();
     
-    void generate(const PerlinNoise& perlin);
-    void generateWithNeighbors(const PerlinNoise& perlin, int northLOD, int southLOD, int eastLOD, int westLOD);
-    void render();
+    // scratch only needs to live for the call; nothing in it is retained
+    void generate(const BiomeGenerator& biomes, const PerlinNoise& perlin, const ChunkIndexCache& indexCache, MeshScratch& scratch);
+    void generateWithNeighbors(const BiomeGenerator& biomes, const PerlinNoise& perlin, const ChunkIndexCache& indexCache,
+                               MeshScratch& scratch, int northLOD, int southLOD, int eastLOD, int westLOD);
+    
+    // generate() in two halves. build() only reads the generators and
+    // index cache and writes this chunk and scratch, so it can run on a
+    // worker thread while nothing else touches the chunk; upload() needs the
+    // GL context and the same scratch. Edges start unstitched.
+    void build(const BiomeGenerator& biomes, const PerlinNoise& perlin, const ChunkIndexCache& indexCache, MeshScratch& scratch);
+    void upload(const ChunkIndexCache& indexCache, const MeshScratch& scratch);
+    
+    // Switch to the index variant for the given neighbour LODs (-1 for none)
+    // without touching the vertices. Returns true if the indices changed.
+    bool stitchToNeighbors(const ChunkIndexCache& indexCache, int northLOD, int southLOD, int eastLOD, int westLOD);
+    
+    // This chunk's draw for ChunkArena::draw; morph is its LOD range under
+    // LodMode::MORPH. Arena offsets move, so ask again for every pass.
+    ChunkArena::Draw getDraw(const LodMorphRange& morph = {}) const;
     void setLOD(int lod);
     int getLOD() const { return lodLevel; }
     
+    VertexFormat getVertexFormat() const { return vertexFormat; }
+    std::size_t getVertexCount() const { return vertexCount; }
+    std::size_t getVertexBytes() const { return vertexCount * vertexSize(vertexFormat); }
+    GLsizei getIndexCount() const { return drawIndices.count; }
+    unsigned int getStitchedEdges() const { return stitchedEdges; }
+    MeshMode getMeshMode() const { return meshMode; }
+    std::size_t getTriangleCount() const { return triangleCount; }
+    std::size_t getGridTriangleCount() const { return 2 * static_cast<std::size_t>(vertexResolution - 1) * (vertexResolution - 1); }
+    float getMeshError() const { return meshError; }
+    std::size_t getAdaptiveBytes() const;
+    HeightTileStore::Instance getTileInstance() const;
+    glm::vec3 getBoundsMin() const { return boundsMin; }
+    glm::vec3 getBoundsMax() const { return boundsMax; }
+    
+    // Empty unless the chunk was created with ChunkMeshOptions::keepCpuMesh
+    const std::vector<TerrainVertex>& getKeptVertices() const { return keptVertices; }
+    const std::vector<CompactTerrainVertex>& getKeptCompactVertices() const { return keptCompactVertices; }
+    std::size_t getRetainedBytes() const;
+    
     glm::ivec2 getCoord() const { return chunkCoord; }
     glm::vec3 getWorldPosition() const;
     float getDistanceFrom(const glm::vec3& pos) const;
-    bool isVisible(const glm::mat4& viewProjection) const;
 };
\ No newline at end of file
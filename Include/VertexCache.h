@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+#include "GridIndices.h"
+
+// Post-transform vertex cache: measuring how often an index list makes the
+// GPU shade a vertex again, and reordering triangle lists so it happens less.
+// The cache is modelled as a FIFO, which is what the usual ACMR figures use.
+
+constexpr int VERTEX_CACHE_SIZE = 32;
+
+// Strip bands narrow enough that a row's shared vertices are still cached
+// when the row below reuses them (buildGridStrips' bandCells). A band row
+// fetches both of its vertex rows interleaved, so together they must fit.
+constexpr int STRIP_BAND_CELLS = VERTEX_CACHE_SIZE / 2 - 1;
+
+struct VertexCacheStats {
+    std::size_t triangles = 0; // Non-degenerate triangles drawn
+    std::size_t vertices = 0;  // Distinct vertices referenced
+    std::size_t misses = 0;    // Vertex shader invocations
+    
+    // Average cache miss ratio: shaded vertices per triangle. A regular
+    // grid can approach 0.5, a list with no reuse at all is 3.
+    double acmr() const { return triangles > 0 ? static_cast<double>(misses) / triangles : 0.0; }
+    
+    // Average transformed vertex ratio: shaded vertices per distinct
+    // vertex, 1 at best whatever the mesh
+    double atvr() const { return vertices > 0 ? static_cast<double>(misses) / vertices : 0.0; }
+};
+
+// Simulates drawing indices as GL_TRIANGLES, or for STRIPS as
+// GL_TRIANGLE_STRIP with primitive restart at restartIndex
+VertexCacheStats measureVertexCache(std::span<const unsigned int> indices, IndexEncoding encoding,
+                                    unsigned int restartIndex = 0xFFFFFFFFu, int cacheSize = VERTEX_CACHE_SIZE);
+
+// Tom Forsyth's linear-speed vertex cache optimisation: the same triangles,
+// each with its winding, in an order that keeps recently used vertices in
+// the cache. vertexCount bounds the indices.
+std::vector<unsigned int> optimizeVertexCache(std::span<const unsigned int> triangles, std::size_t vertexCount);
\ No newline at end of file
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <glm/glm.hpp>
+
+// Chunk vertex layouts, selected by terrain.vertexFormat in config.json
+enum class VertexFormat {
+    FULL,       // TerrainVertex, 36 bytes
+    COMPACT,    // CompactTerrainVertex, 8 bytes
+    HEIGHT_TILE // No vertex buffer; one HeightTileTexel per vertex in a
+                // HeightTileStore texture array, drawn instanced
+};
+
+// Interleaved chunk vertex. color is the blended biome color as RGBA8,
+// read by the shader as a normalized GL_UNSIGNED_BYTE x4 attribute.
+struct TerrainVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+    std::uint32_t color;
+};
+
+// Quantized chunk vertex. X/Z and texture coordinates are implied by the
+// grid index; terrain.vert and shadow.vert rebuild them from the chunk's
+// ChunkAttributes and the chunk size.
+struct CompactTerrainVertex {
+    std::uint16_t height;    // HeightQuantization steps above the chunk's base
+    std::uint16_t gridIndex; // z * resolution + x
+    std::int8_t normal[2];   // Hemi-octahedral, snorm8
+    std::uint16_t color;     // RGB565
+};
+
+// CompactTerrainVertex without the grid index, which is the texel's
+// position in the tile. Uploaded as one GL_RGB16UI texel.
+struct HeightTileTexel {
+    std::uint16_t height;  // HeightQuantization steps above the chunk's base
+    std::int8_t normal[2]; // Hemi-octahedral, snorm8
+    std::uint16_t color;   // RGB565
+};
+
+static_assert(sizeof(TerrainVertex) == 36);
+static_assert(sizeof(CompactTerrainVertex) == 8);
+static_assert(sizeof(HeightTileTexel) == 6);
+
+// Fixed-step height quantization. base is a whole number of steps and the
+// step is a power of two, so a height decodes to the same float in every
+// chunk it appears in and shared edge vertices stay watertight.
+struct HeightQuantization {
+    static constexpr float MIN_STEP = 1.0f / 64.0f;
+    
+    float base;
+    float step;
+    
+    // Smallest step (at least MIN_STEP) that covers [minHeight, maxHeight]
+    static HeightQuantization fromRange(float minHeight, float maxHeight);
+    
+    std::uint16_t encode(float height) const;
+    float decode(std::uint16_t value) const { return base + static_cast<float>(value) * step; }
+};
+
+// Per-chunk shader inputs, one per instance or multi-draw command at
+// attribute locations 7-9 of terrain.vert and shadow.vert
+struct ChunkAttributes {
+    float originX;
+    float originZ;
+    float heightBase; // HeightQuantization of compact and tile heights
+    float heightStep;
+    std::uint32_t base;        // First vertex in the ChunkArena, or the height tile's array layer
+    std::uint32_t pinnedEdges; // ChunkEdge mask of edges that must not morph
+    std::uint32_t resolution;  // Grid vertices per row at the chunk's LOD
+    float morphStart;          // LodMorphRange; equal when the chunk does not morph
+    float morphEnd;
+};
+
+static_assert(sizeof(ChunkAttributes) == 36);
+
+VertexFormat parseVertexFormat(const std::string& name);
+const char* vertexFormatName(VertexFormat format);
+std::size_t vertexSize(VertexFormat format);
+
+std::uint32_t packColorRGBA8(const glm::vec3& color);
+std::uint16_t packColor565(const glm::vec3& color);
+glm::vec3 unpackColor565(std::uint16_t color);
+
+// Upper hemisphere (y > 0) normals only, which is all a heightfield produces
+void encodeHemiOctahedral(const glm::vec3& normal, std::int8_t out[2]);
+glm::vec3 decodeHemiOctahedral(const std::int8_t encoded[2]);
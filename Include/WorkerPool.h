@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads running jobs off the render thread. Jobs start in
+// the order they were submitted; their results come back through a queue
+// the owner drains with collect() on its own thread, so nothing a job
+// returns is touched by two threads at once.
+template <typename Result>
+class WorkerPool {
+public:
+    using Job = std::move_only_function<Result()>;
+    
+    // At least one thread, whatever is asked for
+    explicit WorkerPool(int threadCount) {
+        for (int i = 0; i < std::max(threadCount, 1); ++i) {
+            threads.emplace_back([this] { run(); });
+        }
+    }
+    
+    // Jobs not yet started are dropped; running ones finish first
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            jobs.clear();
+        }
+        jobReady.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+    
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    void submit(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+            outstanding++;
+        }
+        jobReady.notify_one();
+    }
+    
+    // Appends the results finished so far, in the order they finished. With
+    // wait, blocks until there is at least one unless nothing is
+    // outstanding. A job that threw rethrows here, once every result
+    // finished so far has been appended. Returns how many were appended.
+    std::size_t collect(std::vector<Result>& finished, bool wait = false) {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (wait) {
+            resultReady.wait(lock, [this] { return !results.empty() || failure || outstanding == 0; });
+        }
+        std::size_t collected = results.size();
+        for (Result& result : results) {
+            finished.push_back(std::move(result));
+        }
+        results.clear();
+        outstanding -= collected;
+        if (failure) {
+            std::exception_ptr error = failure;
+            failure = nullptr;
+            outstanding--;
+            std::rethrow_exception(error);
+        }
+        return collected;
+    }
+    
+    // Submitted and not yet collected, running or not
+    std::size_t getOutstanding() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return outstanding;
+    }
+    
+    int getThreadCount() const { return static_cast<int>(threads.size()); }
+    
+private:
+    mutable std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable resultReady;
+    std::deque<Job> jobs;
+    std::vector<Result> results;
+    std::exception_ptr failure; // The first job to throw since the last collect()
+    std::size_t outstanding = 0;
+    bool stopping = false;
+    std::vector<std::thread> threads; // Last, so the rest exists before they start
+    
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+            
+            lock.unlock();
+            try {
+                Result result = job();
+                lock.lock();
+                results.push_back(std::move(result));
+            } catch (...) {
+                if (!lock.owns_lock()) {
+                    lock.lock();
+                }
+                if (!failure) {
+                    failure = std::current_exception();
+                } else {
+                    outstanding--; // Only the first is reported
+                }
+            }
+            resultReady.notify_all();
+        }
+    }
+};
\ No newline at end of file
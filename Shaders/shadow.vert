@@ -1,9 +1,90 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 4) in uvec2 aHeightIndex;
+layout (location = 7) in vec4 aChunk;
+layout (location = 8) in uvec3 aChunkBase;
+layout (location = 9) in vec2 aChunkMorph;
 
 uniform mat4 lightSpaceMatrix;
 
+// Compact vertex format and height tiles, reconstructed as in terrain.vert
+uniform bool compactVertices;
+uniform float chunkSize;
+uniform bool heightTiles;
+uniform usampler2DArray heightTileArray;
+
+// LOD morphing, as in terrain.vert, so shadows match the drawn surface
+uniform vec3 lodCenter;
+uniform usamplerBuffer chunkVertices;
+
+struct Chunk {
+    vec2 origin;
+    float quantBase;
+    float quantStep;
+    int base;
+    int pinnedEdges;
+    int resolution;
+    vec2 morphRange;
+};
+
+vec2 gridOffset(Chunk chunk, ivec2 grid) {
+    int last = chunk.resolution - 1;
+    return mix(vec2(grid) * (chunkSize / float(last)), vec2(chunkSize), equal(grid, ivec2(last)));
+}
+
+uint tileHeight(Chunk chunk, ivec2 grid) {
+    return texelFetch(heightTileArray, ivec3(grid, chunk.base), 0).r;
+}
+
+vec3 morphPosition(Chunk chunk, vec3 position, int index) {
+    int last = chunk.resolution - 1;
+    ivec2 grid = ivec2(index % chunk.resolution, index / chunk.resolution);
+    ivec2 coarse = grid - (grid & 1);
+    bool pinned = ((chunk.pinnedEdges & 1) != 0 && grid.y == 0) || ((chunk.pinnedEdges & 2) != 0 && grid.y == last) ||
+                  ((chunk.pinnedEdges & 4) != 0 && grid.x == last) || ((chunk.pinnedEdges & 8) != 0 && grid.x == 0);
+    if (pinned || coarse == grid) {
+        return position;
+    }
+    
+    float distance = length(lodCenter - vec3(position.x, 0.0, position.z));
+    float k = clamp((distance - chunk.morphRange.x) / (chunk.morphRange.y - chunk.morphRange.x), 0.0, 1.0);
+    
+    int coarseIndex = chunk.base + coarse.y * chunk.resolution + coarse.x;
+    vec3 target;
+    if (heightTiles || compactVertices) {
+        uint quantized = heightTiles ? tileHeight(chunk, coarse) : texelFetch(chunkVertices, coarseIndex * 2).r & 0xFFFFu;
+        vec2 offset = gridOffset(chunk, coarse);
+        target = vec3(chunk.origin.x + offset.x, chunk.quantBase + float(quantized) * chunk.quantStep, chunk.origin.y + offset.y);
+    } else {
+        target = uintBitsToFloat(uvec3(texelFetch(chunkVertices, coarseIndex * 9).r,
+                                       texelFetch(chunkVertices, coarseIndex * 9 + 1).r,
+                                       texelFetch(chunkVertices, coarseIndex * 9 + 2).r));
+    }
+    return mix(position, target, k);
+}
+
 void main() {
+    Chunk chunk;
+    chunk.origin = aChunk.xy;
+    chunk.quantBase = aChunk.z;
+    chunk.quantStep = aChunk.w;
+    chunk.base = int(aChunkBase.x);
+    chunk.pinnedEdges = int(aChunkBase.y);
+    chunk.resolution = int(aChunkBase.z);
+    chunk.morphRange = aChunkMorph;
+    int index = compactVertices ? int(aHeightIndex.y) : gl_VertexID - (heightTiles ? 0 : chunk.base);
+    
+    vec3 position = aPos;
+    if (compactVertices || heightTiles) {
+        ivec2 grid = ivec2(index % chunk.resolution, index / chunk.resolution);
+        vec2 offset = gridOffset(chunk, grid);
+        uint quantized = heightTiles ? tileHeight(chunk, grid) : aHeightIndex.x;
+        position = vec3(chunk.origin.x + offset.x, chunk.quantBase + float(quantized) * chunk.quantStep, chunk.origin.y + offset.y);
+    }
+    if (chunk.morphRange.y > chunk.morphRange.x) {
+        position = morphPosition(chunk, position, index);
+    }
+    
     // Vertices are already in world space
-    gl_Position = lightSpaceMatrix * vec4(aPos, 1.0);
+    gl_Position = lightSpaceMatrix * vec4(position, 1.0);
 }
\ No newline at end of file
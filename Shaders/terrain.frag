@@ -4,12 +4,12 @@ out vec4 FragColor;
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
+in vec3 Color;
 in vec4 FragPosLightSpace;
 
 uniform vec3 lightPos;
 uniform vec3 viewPos;
 uniform sampler2D shadowMap;
-uniform vec3 biomeColor;
 uniform float fogDensity;
 uniform float fogStart;
 uniform vec3 fogColor;
@@ -41,10 +41,8 @@ float ShadowCalculation(vec4 fragPosLightSpace) {
 }
 
 void main() {
-    // Use height-based coloring mixed with biome color
-    float height = FragPos.y / 50.0;
-    vec3 heightColor = mix(vec3(0.2, 0.5, 0.2), vec3(0.8, 0.8, 0.8), height);
-    vec3 color = mix(heightColor, biomeColor, 0.3);
+    // Biome color baked per vertex at chunk generation
+    vec3 color = Color;
     
     // Calculate shadow
     float shadow = ShadowCalculation(FragPosLightSpace);
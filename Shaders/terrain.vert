@@ -2,10 +2,24 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec4 aColor;
+
+// Compact vertex format (see VertexFormat.h)
+layout (location = 4) in uvec2 aHeightIndex; // quantized height, z * resolution + x
+layout (location = 5) in vec2 aOctNormal;    // hemi-octahedral normal
+layout (location = 6) in uint aColor565;
+
+// Per chunk, one per instance or multi-draw command (ChunkAttributes in
+// VertexFormat.h). Height tiles have no vertex attributes at all, the
+// element index is the grid index.
+layout (location = 7) in vec4 aChunk;       // origin x, origin z, heightBase, heightStep
+layout (location = 8) in uvec3 aChunkBase;  // first vertex or tile layer, pinned edges, resolution
+layout (location = 9) in vec2 aChunkMorph;  // morph start and end distance
 
 out vec3 FragPos;
 out vec3 Normal;
 out vec2 TexCoords;
+out vec3 Color;
 out vec4 FragPosLightSpace;
 out float ClipDistance;
 
@@ -15,11 +29,125 @@ uniform mat4 projection;
 uniform mat4 lightSpaceMatrix;
 uniform vec4 clipPlane;
 
+uniform bool compactVertices;
+uniform float chunkSize;
+
+uniform bool heightTiles;
+uniform usampler2DArray heightTileArray; // height, hemi-octahedral normal, RGB565 color
+
+// CDLOD-style morphing (LodMode::MORPH, see LodMorph.h). Odd vertices
+// slide onto their even predecessor, which is where the next LOD has its
+// vertex, so the chunk already looks like that LOD when it switches.
+uniform vec3 lodCenter;
+uniform usamplerBuffer chunkVertices; // The ChunkArena vertex buffer as 32-bit words
+
+struct Chunk {
+    vec2 origin;
+    float quantBase;
+    float quantStep;
+    int base;        // First vertex in chunkVertices, or the tile layer
+    int pinnedEdges; // ChunkEdge mask of edges facing a finer chunk
+    int resolution;
+    vec2 morphRange; // Start and end distance; empty when the chunk does not morph
+};
+
+// Same grid spacing as TerrainChunk, with the last row and column exactly
+// on the chunk boundary so neighbours meet without cracks
+vec2 gridOffset(Chunk chunk, ivec2 grid) {
+    int last = chunk.resolution - 1;
+    return mix(vec2(grid) * (chunkSize / float(last)), vec2(chunkSize), equal(grid, ivec2(last)));
+}
+
+vec3 decodeNormal(vec2 oct) {
+    vec2 p = vec2(oct.x + oct.y, oct.x - oct.y) * 0.5;
+    return normalize(vec3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y));
+}
+
+vec3 decodeColor565(uint color) {
+    return vec3(float(color >> 11u) / 31.0, float((color >> 5u) & 63u) / 63.0, float(color & 31u) / 31.0);
+}
+
+uvec3 tileTexel(Chunk chunk, ivec2 grid) {
+    return texelFetch(heightTileArray, ivec3(grid, chunk.base), 0).rgb;
+}
+
+vec3 morphPosition(Chunk chunk, vec3 position, int index) {
+    int last = chunk.resolution - 1;
+    ivec2 grid = ivec2(index % chunk.resolution, index / chunk.resolution);
+    ivec2 coarse = grid - (grid & 1);
+    bool pinned = ((chunk.pinnedEdges & 1) != 0 && grid.y == 0) || ((chunk.pinnedEdges & 2) != 0 && grid.y == last) ||
+                  ((chunk.pinnedEdges & 4) != 0 && grid.x == last) || ((chunk.pinnedEdges & 8) != 0 && grid.x == 0);
+    if (pinned || coarse == grid) {
+        return position;
+    }
+    
+    float distance = length(lodCenter - vec3(position.x, 0.0, position.z));
+    float k = clamp((distance - chunk.morphRange.x) / (chunk.morphRange.y - chunk.morphRange.x), 0.0, 1.0);
+    
+    int coarseIndex = chunk.base + coarse.y * chunk.resolution + coarse.x;
+    vec3 target;
+    if (heightTiles || compactVertices) {
+        // Compact vertices are two words; the quantized height is the low half of the first
+        uint quantized = heightTiles ? tileTexel(chunk, coarse).r : texelFetch(chunkVertices, coarseIndex * 2).r & 0xFFFFu;
+        vec2 offset = gridOffset(chunk, coarse);
+        target = vec3(chunk.origin.x + offset.x, chunk.quantBase + float(quantized) * chunk.quantStep, chunk.origin.y + offset.y);
+    } else {
+        // Nine words per vertex, position first
+        target = uintBitsToFloat(uvec3(texelFetch(chunkVertices, coarseIndex * 9).r,
+                                       texelFetch(chunkVertices, coarseIndex * 9 + 1).r,
+                                       texelFetch(chunkVertices, coarseIndex * 9 + 2).r));
+    }
+    return mix(position, target, k);
+}
+
 void main() {
-    vec4 worldPos = model * vec4(aPos, 1.0);
+    vec3 position = aPos;
+    vec3 normal = aNormal;
+    vec2 texCoords = aTexCoords;
+    vec3 color = aColor.rgb;
+    
+    Chunk chunk;
+    chunk.origin = aChunk.xy;
+    chunk.quantBase = aChunk.z;
+    chunk.quantStep = aChunk.w;
+    chunk.base = int(aChunkBase.x);
+    chunk.pinnedEdges = int(aChunkBase.y);
+    chunk.resolution = int(aChunkBase.z);
+    chunk.morphRange = aChunkMorph;
+    
+    // Full and tile vertices are drawn with their grid index as the element
+    // index; gl_VertexID includes the arena base vertex, tiles have none
+    int index = compactVertices ? int(aHeightIndex.y) : gl_VertexID - (heightTiles ? 0 : chunk.base);
+    
+    if (compactVertices || heightTiles) {
+        int last = chunk.resolution - 1;
+        ivec2 grid = ivec2(index % chunk.resolution, index / chunk.resolution);
+        vec2 offset = gridOffset(chunk, grid);
+        texCoords = vec2(grid) / float(last);
+        
+        if (heightTiles) {
+            // Normal bytes are the low and high halves of the second channel
+            uvec3 texel = tileTexel(chunk, grid);
+            position = vec3(chunk.origin.x + offset.x, chunk.quantBase + float(texel.r) * chunk.quantStep, chunk.origin.y + offset.y);
+            ivec2 octBytes = ivec2(int(texel.g << 24u) >> 24, int(texel.g << 16u) >> 24);
+            normal = decodeNormal(max(vec2(octBytes) / 127.0, vec2(-1.0)));
+            color = decodeColor565(texel.b);
+        } else {
+            position = vec3(chunk.origin.x + offset.x, chunk.quantBase + float(aHeightIndex.x) * chunk.quantStep, chunk.origin.y + offset.y);
+            normal = decodeNormal(aOctNormal);
+            color = decodeColor565(aColor565);
+        }
+    }
+    
+    if (chunk.morphRange.y > chunk.morphRange.x) {
+        position = morphPosition(chunk, position, index);
+    }
+    
+    vec4 worldPos = model * vec4(position, 1.0);
     FragPos = worldPos.xyz;
-    Normal = mat3(transpose(inverse(model))) * aNormal;
-    TexCoords = aTexCoords;
+    Normal = mat3(transpose(inverse(model))) * normal;
+    TexCoords = texCoords;
+    Color = color;
     FragPosLightSpace = lightSpaceMatrix * worldPos;
     
     gl_Position = projection * view * worldPos;
@@ -0,0 +1,196 @@
+#include "AdaptiveMesh.h"
+#include "GridIndices.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Every RTIN triangle whose hypotenuse midpoint is a grid vertex, finest
+// first, as visit(ax, az, bx, bz, cx, cz, finest) with hypotenuse a-b and
+// right angle at c. Triangle i is node i + 2 of an implicit binary tree whose
+// roots are the two halves of the chunk; each bit below the root picks the
+// half to descend into.
+template <typename Visit>
+void forEachRtinTriangle(int vertexResolution, Visit visit) {
+    const int tileSize = vertexResolution - 1;
+    const int finestCount = tileSize * tileSize;
+    const int triangleCount = finestCount * 2 - 2;
+    for (int i = triangleCount - 1; i >= 0; --i) {
+        int id = i + 2;
+        int ax = 0, az = 0, bx = 0, bz = 0, cx = 0, cz = 0;
+        if (id & 1) {
+            bx = bz = cx = tileSize;
+        } else {
+            ax = az = cz = tileSize;
+        }
+        while ((id >>= 1) > 1) {
+            int mx = (ax + bx) >> 1;
+            int mz = (az + bz) >> 1;
+            if (id & 1) {
+                bx = ax;
+                bz = az;
+                ax = cx;
+                az = cz;
+            } else {
+                ax = bx;
+                az = bz;
+                bx = cx;
+                bz = cz;
+            }
+            cx = mx;
+            cz = mz;
+        }
+        visit(ax, az, bx, bz, cx, cz, i >= triangleCount - finestCount);
+    }
+}
+
+// Twice the signed area of (a, b, p); exact on grid coordinates
+int edgeFunction(int ax, int az, int bx, int bz, int px, int pz) {
+    return (bx - ax) * (pz - az) - (bz - az) * (px - ax);
+}
+
+// Largest vertical distance between the grid samples inside or on triangle
+// (a, b, c) and the plane through its corners
+float triangleDeviation(std::span<const float> heights, int vertexResolution, int ax, int az, int bx, int bz, int cx, int cz) {
+    const int area = edgeFunction(ax, az, bx, bz, cx, cz);
+    if (area == 0) {
+        return 0.0f;
+    }
+    const float ha = heights[az * vertexResolution + ax];
+    const float hb = heights[bz * vertexResolution + bx];
+    const float hc = heights[cz * vertexResolution + cx];
+    
+    float deviation = 0.0f;
+    for (int z = std::min({az, bz, cz}); z <= std::max({az, bz, cz}); ++z) {
+        for (int x = std::min({ax, bx, cx}); x <= std::max({ax, bx, cx}); ++x) {
+            const int wa = edgeFunction(bx, bz, cx, cz, x, z);
+            const int wb = edgeFunction(cx, cz, ax, az, x, z);
+            const int wc = edgeFunction(ax, az, bx, bz, x, z);
+            const bool inside = area > 0 ? (wa >= 0 && wb >= 0 && wc >= 0) : (wa <= 0 && wb <= 0 && wc <= 0);
+            if (inside) {
+                const float interpolated = (wa * ha + wb * hb + wc * hc) / area;
+                deviation = std::max(deviation, std::abs(interpolated - heights[z * vertexResolution + x]));
+            }
+        }
+    }
+    return deviation;
+}
+
+// Odd vertices on stitched edges, which the coarser neighbour does not have
+bool droppedVertex(int x, int z, int vertexResolution, unsigned int stitchedEdges) {
+    const int last = vertexResolution - 1;
+    return ((x % 2 == 1) && (((stitchedEdges & EDGE_NORTH) && z == 0) || ((stitchedEdges & EDGE_SOUTH) && z == last))) ||
+           ((z % 2 == 1) && (((stitchedEdges & EDGE_WEST) && x == 0) || ((stitchedEdges & EDGE_EAST) && x == last)));
+}
+
+struct RtinExtraction {
+    std::span<const float> errors;
+    int vertexResolution;
+    float maxError;
+    unsigned int stitchedEdges;
+    std::vector<unsigned int>& indices;
+    
+    void addTriangle(int ax, int az, int bx, int bz, int cx, int cz) {
+        const int mx = (ax + bx) >> 1;
+        const int mz = (az + bz) >> 1;
+        const bool leaf = std::abs(ax - cx) + std::abs(az - cz) <= 1;
+        if (!leaf && !droppedVertex(mx, mz, vertexResolution, stitchedEdges) &&
+            errors[mz * vertexResolution + mx] > maxError) {
+            addTriangle(cx, cz, ax, az, mx, mz);
+            addTriangle(bx, bz, cx, cz, mx, mz);
+            return;
+        }
+        
+        // Same winding as the grid triangles
+        if ((bx - ax) * (cz - az) - (bz - az) * (cx - ax) > 0) {
+            std::swap(bx, cx);
+            std::swap(bz, cz);
+        }
+        indices.push_back(az * vertexResolution + ax);
+        indices.push_back(bz * vertexResolution + bx);
+        indices.push_back(cz * vertexResolution + cx);
+    }
+};
+
+} // namespace
+
+MeshMode parseMeshMode(const std::string& name) {
+    if (name == "grid") return MeshMode::GRID;
+    if (name == "adaptive") return MeshMode::ADAPTIVE;
+    throw std::runtime_error("Unknown mesh mode: " + name);
+}
+
+const char* meshModeName(MeshMode mode) {
+    return mode == MeshMode::ADAPTIVE ? "adaptive" : "grid";
+}
+
+bool canBuildAdaptiveMesh(int vertexResolution) {
+    const int cells = vertexResolution - 1;
+    return cells >= 1 && (cells & (cells - 1)) == 0;
+}
+
+void rtinErrors(std::span<const float> heights, int vertexResolution, std::span<float> errors) {
+    std::fill(errors.begin(), errors.end(), 0.0f);
+    forEachRtinTriangle(vertexResolution, [&](int ax, int az, int bx, int bz, int cx, int cz, bool finest) {
+        // The whole triangle is checked, not just its hypotenuse midpoint,
+        // so the bound also holds for samples deeper inside it
+        float& middle = errors[((az + bz) >> 1) * vertexResolution + ((ax + bx) >> 1)];
+        middle = std::max(middle, triangleDeviation(heights, vertexResolution, ax, az, bx, bz, cx, cz));
+        if (finest) {
+            return;
+        }
+        
+        // Both triangles on this hypotenuse add their children, so a
+        // vertex is only left out once neither side needs splitting
+        const float leftChild = errors[((az + cz) >> 1) * vertexResolution + ((ax + cx) >> 1)];
+        const float rightChild = errors[((bz + cz) >> 1) * vertexResolution + ((bx + cx) >> 1)];
+        middle = std::max({middle, leftChild, rightChild});
+    });
+}
+
+std::vector<unsigned int> buildAdaptiveTriangles(std::span<const float> errors, int vertexResolution, float maxError,
+                                                 unsigned int stitchedEdges) {
+    if (!canStitchEdges(vertexResolution)) {
+        stitchedEdges = 0;
+    }
+    
+    // Edge vertices are forced in by giving them, and so every triangle
+    // that has to split before them, an unbounded error
+    std::vector<float> forced(errors.begin(), errors.end());
+    const float always = std::numeric_limits<float>::infinity();
+    const int last = vertexResolution - 1;
+    for (int i = 0; i < vertexResolution; ++i) {
+        const int edgeVertices[4][2] = {{i, 0}, {i, last}, {0, i}, {last, i}};
+        for (const auto& [x, z] : edgeVertices) {
+            if (!droppedVertex(x, z, vertexResolution, stitchedEdges)) {
+                forced[z * vertexResolution + x] = always;
+            }
+        }
+    }
+    forEachRtinTriangle(vertexResolution, [&](int ax, int az, int bx, int bz, int cx, int cz, bool finest) {
+        if (!finest) {
+            float& middle = forced[((az + bz) >> 1) * vertexResolution + ((ax + bx) >> 1)];
+            middle = std::max({middle, forced[((az + cz) >> 1) * vertexResolution + ((ax + cx) >> 1)],
+                               forced[((bz + cz) >> 1) * vertexResolution + ((bx + cx) >> 1)]});
+        }
+    });
+    
+    std::vector<unsigned int> indices;
+    RtinExtraction extraction{forced, vertexResolution, maxError, stitchedEdges, indices};
+    extraction.addTriangle(0, 0, last, last, last, 0);
+    extraction.addTriangle(last, last, 0, 0, 0, last);
+    return indices;
+}
+
+float triangulationError(std::span<const float> heights, int vertexResolution, std::span<const unsigned int> triangles) {
+    float maxError = 0.0f;
+    for (std::size_t t = 0; t + 2 < triangles.size(); t += 3) {
+        const unsigned int a = triangles[t], b = triangles[t + 1], c = triangles[t + 2];
+        maxError = std::max(maxError, triangleDeviation(heights, vertexResolution, a % vertexResolution, a / vertexResolution,
+                                                        b % vertexResolution, b / vertexResolution,
+                                                        c % vertexResolution, c / vertexResolution));
+    }
+    return maxError;
+}
\ No newline at end of file
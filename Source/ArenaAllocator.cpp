@@ -0,0 +1,113 @@
+#include "ArenaAllocator.h"
+#include <algorithm>
+
+ArenaAllocator::ArenaAllocator(std::size_t capacity) : capacity(capacity), used(0) {
+    if (capacity > 0) {
+        freeRanges[0] = capacity;
+    }
+}
+
+ArenaAllocator::Handle ArenaAllocator::allocate(std::size_t size) {
+    std::size_t offset = 0;
+    if (size > 0) {
+        auto it = std::find_if(freeRanges.begin(), freeRanges.end(), [size](const auto& range) { return range.second >= size; });
+        if (it == freeRanges.end()) {
+            return NONE;
+        }
+        
+        // Carve from the front so the rest stays where it was in the map
+        offset = it->first;
+        std::size_t rest = it->second - size;
+        freeRanges.erase(it);
+        if (rest > 0) {
+            freeRanges[offset + size] = rest;
+        }
+        used += size;
+    }
+    
+    Handle handle;
+    if (!freeHandles.empty()) {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+        ranges[handle] = {offset, size};
+    } else {
+        handle = static_cast<Handle>(ranges.size());
+        ranges.push_back({offset, size});
+    }
+    return handle;
+}
+
+void ArenaAllocator::release(Handle handle) {
+    if (handle == NONE) {
+        return;
+    }
+    const Range range = ranges[handle];
+    if (range.size > 0) {
+        addFree(range.offset, range.size);
+        used -= range.size;
+    }
+    ranges[handle] = {0, 0};
+    freeHandles.push_back(handle);
+}
+
+void ArenaAllocator::addFree(std::size_t offset, std::size_t size) {
+    // Merge with the free ranges on either side
+    auto next = freeRanges.lower_bound(offset);
+    if (next != freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        next = freeRanges.erase(next);
+    }
+    if (next != freeRanges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+    freeRanges[offset] = size;
+}
+
+std::vector<ArenaAllocator::Move> ArenaAllocator::compact() {
+    std::vector<Handle> live;
+    for (Handle handle = 0; handle < static_cast<Handle>(ranges.size()); ++handle) {
+        if (ranges[handle].size > 0) {
+            live.push_back(handle);
+        }
+    }
+    std::sort(live.begin(), live.end(), [this](Handle a, Handle b) { return ranges[a].offset < ranges[b].offset; });
+    
+    std::vector<Move> moves;
+    std::size_t end = 0;
+    for (Handle handle : live) {
+        Range& range = ranges[handle];
+        if (!moves.empty() && moves.back().from + moves.back().size == range.offset) {
+            moves.back().size += range.size;
+        } else {
+            moves.push_back({range.offset, end, range.size});
+        }
+        range.offset = end;
+        end += range.size;
+    }
+    
+    freeRanges.clear();
+    if (end < capacity) {
+        freeRanges[end] = capacity - end;
+    }
+    return moves;
+}
+
+void ArenaAllocator::grow(std::size_t newCapacity) {
+    if (newCapacity <= capacity) {
+        return;
+    }
+    addFree(capacity, newCapacity - capacity);
+    capacity = newCapacity;
+}
+
+std::size_t ArenaAllocator::getLargestFree() const {
+    std::size_t largest = 0;
+    for (const auto& [offset, size] : freeRanges) {
+        largest = std::max(largest, size);
+    }
+    return largest;
+}
\ No newline at end of file
@@ -1,170 +1,289 @@
 #include "Biome.h"
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-const BiomeParams BiomeGenerator::DESERT_PARAMS = {
-    25.0f,                                    // heightScale - rolling dunes
-    0.2f,                                     // roughness - smooth dunes
-    glm::vec3(0.96f, 0.87f, 0.5f),          // baseColor (bright sand)
-    glm::vec3(0.85f, 0.65f, 0.35f),         // midColor (orange sand)
-    glm::vec3(0.6f, 0.4f, 0.2f),            // peakColor (dark rock)
-    15.0f,                                    // colorThreshold1
-    25.0f                                     // colorThreshold2
-};
+namespace {
 
-const BiomeParams BiomeGenerator::FOREST_PARAMS = {
-    40.0f,                                    // heightScale - rolling hills
-    0.6f,                                     // roughness - varied terrain
-    glm::vec3(0.15f, 0.5f, 0.1f),           // baseColor (lush grass)
-    glm::vec3(0.08f, 0.3f, 0.05f),          // midColor (deep forest)
-    glm::vec3(0.4f, 0.35f, 0.25f),          // peakColor (earthy brown)
-    20.0f,                                    // colorThreshold1
-    35.0f                                     // colorThreshold2
-};
+// The names BiomeType values are configured under, in enum order
+constexpr std::array<const char*, 4> BIOME_TYPE_NAMES = {"desert", "forest", "mountains", "tundra"};
 
-const BiomeParams BiomeGenerator::MOUNTAIN_PARAMS = {
-    120.0f,                                   // heightScale - tall peaks
-    0.9f,                                     // roughness - very rough
-    glm::vec3(0.4f, 0.35f, 0.3f),           // baseColor (dark rock)
-    glm::vec3(0.55f, 0.5f, 0.45f),          // midColor (granite)
-    glm::vec3(1.0f, 1.0f, 1.0f),            // peakColor (pure snow)
-    40.0f,                                    // colorThreshold1
-    70.0f                                     // colorThreshold2
-};
+} // namespace
 
-const BiomeParams BiomeGenerator::TUNDRA_PARAMS = {
-    30.0f,                                    // heightScale - low hills
-    0.5f,                                     // roughness - moderate
-    glm::vec3(0.35f, 0.45f, 0.35f),         // baseColor (arctic grass)
-    glm::vec3(0.75f, 0.8f, 0.85f),          // midColor (permafrost)
-    glm::vec3(0.95f, 0.97f, 1.0f),          // peakColor (glacial ice)
-    12.0f,                                    // colorThreshold1
-    22.0f                                     // colorThreshold2
-};
+BiomeGenerator::BiomeGenerator(unsigned int seed, BiomeTable table)
+    : table(std::move(table)),
+      climate(seed, this->table.size(), [this](float temperature, float moisture) {
+          return this->table.classify(temperature, moisture);
+      }) {}
 
-BiomeGenerator::BiomeGenerator(unsigned int seed) : biomeNoise(seed) {}
+int BiomeGenerator::getBiomeId(float x, float z) const {
+    // The strongest blend weight, so the biome reported is always one the
+    // terrain here is blended from; the exact climate fields can classify
+    // differently near a boundary
+    return climate.sampleWeights(x, z).biomes[0];
+}
 
 BiomeType BiomeGenerator::getBiome(float x, float z) const {
-    float temperature = biomeNoise.octaveNoise(x * 0.002, z * 0.002, 0, 3, 0.5);
-    float moisture = biomeNoise.octaveNoise(x * 0.002 + 1000, z * 0.002 + 1000, 0, 3, 0.5);
-    
-    if (temperature > 0.3f) {
-        return moisture > 0 ? BiomeType::FOREST : BiomeType::DESERT;
-    } else {
-        return moisture > 0 ? BiomeType::TUNDRA : BiomeType::MOUNTAINS;
-    }
+    return toBiomeType(getBiomeId(x, z));
 }
 
 BiomeParams BiomeGenerator::getBiomeParams(BiomeType type) const {
-    switch (type) {
-        case BiomeType::DESERT: return DESERT_PARAMS;
-        case BiomeType::FOREST: return FOREST_PARAMS;
-        case BiomeType::MOUNTAINS: return MOUNTAIN_PARAMS;
-        case BiomeType::TUNDRA: return TUNDRA_PARAMS;
+    return getBiomeParams(toBiomeId(type));
+}
+
+// Table ids follow the configured biomes' order, so the two only meet
+// through the name
+BiomeType BiomeGenerator::toBiomeType(int id) const {
+    for (std::size_t type = 0; type < BIOME_TYPE_NAMES.size(); ++type) {
+        if (table.names[id] == BIOME_TYPE_NAMES[type]) {
+            return static_cast<BiomeType>(type);
+        }
     }
-    return FOREST_PARAMS;
+    throw std::out_of_range("Biome has no BiomeType: " + table.names[id]);
 }
 
-float BiomeGenerator::getBiomeBlend(float x, float z, BiomeType& primary, BiomeType& secondary) const {
-    const float blendDistance = 50.0f;
-    
-    primary = getBiome(x, z);
-    
-    BiomeType neighbors[4] = {
-        getBiome(x + blendDistance, z),
-        getBiome(x - blendDistance, z),
-        getBiome(x, z + blendDistance),
-        getBiome(x, z - blendDistance)
+int BiomeGenerator::toBiomeId(BiomeType type) const {
+    const char* name = BIOME_TYPE_NAMES[static_cast<int>(type)];
+    int id = table.findId(name);
+    if (id < 0) {
+        throw std::out_of_range(std::string("Biome not configured: ") + name);
+    }
+    return id;
+}
+
+BiomeParams BiomeGenerator::getBiomeParams(int id) const {
+    if (id < 0 || id >= table.size()) {
+        throw std::out_of_range("Biome id out of range: " + std::to_string(id));
+    }
+    return {
+        table.heightScale[id],
+        table.roughness[id],
+        table.baseColor[id],
+        table.midColor[id],
+        table.peakColor[id],
+        table.colorThreshold1[id],
+        table.colorThreshold2[id]
     };
-    
-    for (int i = 0; i < 4; ++i) {
-        if (neighbors[i] != primary) {
-            secondary = neighbors[i];
-            
-            float distance = blendDistance;
-            for (float d = 0; d < blendDistance; d += 5.0f) {
-                BiomeType test = getBiome(
-                    x + (i == 0 ? d : (i == 1 ? -d : 0)),
-                    z + (i == 2 ? d : (i == 3 ? -d : 0))
-                );
-                if (test != primary) {
-                    distance = d;
-                    break;
-                }
-            }
-            
-            return std::min(1.0f, distance / blendDistance);
-        }
+}
+
+BiomeWeights BiomeGenerator::getBiomeWeights(float x, float z) const {
+    return climate.sampleWeights(x, z);
+}
+
+float BiomeGenerator::getBiomeBlend(float x, float z, BiomeType& primary, BiomeType& secondary) const {
+    // Two-biome view of the weights: the strongest pair, renormalized
+    BiomeWeights weights = climate.sampleWeights(x, z);
+    primary = toBiomeType(weights.biomes[0]);
+    if (weights.count < 2) {
+        secondary = primary;
+        return 1.0f;
     }
-    
-    secondary = primary;
-    return 1.0f;
+    secondary = toBiomeType(weights.biomes[1]);
+    return weights.weights[0] / (weights.weights[0] + weights.weights[1]);
 }
 
 float BiomeGenerator::generateHeight(float x, float z, const PerlinNoise& heightNoise) const {
-    BiomeType primary, secondary;
-    float blend = getBiomeBlend(x, z, primary, secondary);
-    
-    BiomeParams params1 = getBiomeParams(primary);
-    BiomeParams params2 = getBiomeParams(secondary);
-    
-    // Multiple octaves for interesting terrain
-    float scale1 = 0.01f;
-    float scale2 = 0.005f;
-    float scale3 = 0.002f;
-    
-    // Large scale features (continents)
-    float continent1 = heightNoise.octaveNoise(x * scale3, z * scale3, 0, 2, 0.4f);
-    float continent2 = heightNoise.octaveNoise(x * scale3, z * scale3, 100, 2, 0.4f);
+    BiomeHeights heights = generateHeights(x, z, heightNoise);
+    float height = 0.0f;
+    for (int i = 0; i < heights.weights.count; ++i) {
+        height += heights.heights[i] * heights.weights.weights[i];
+    }
+    return height;
+}
+
+namespace {
+
+// Height noise stacks. DETAIL_SCALE is exactly 2 * MEDIUM_SCALE, so medium
+// octave i + 1 lands on the same coordinates as detail octave i and is
+// shared: only the first medium octave is a layer of its own.
+constexpr float DETAIL_SCALE = 0.01f;
+constexpr float MEDIUM_SCALE = 0.005f;
+constexpr float CONTINENT_SCALE = 0.002f;
+constexpr int CONTINENT_OCTAVES = 2;
+constexpr int MEDIUM_OCTAVES = 4;
+constexpr int DETAIL_OCTAVES = 6;
+
+// combineOctaves() applied to values and both derivatives
+NoiseGradient combineGradients(const NoiseGradient* octaves, int count, float persistence) {
+    float values[DETAIL_OCTAVES], dx[DETAIL_OCTAVES], dz[DETAIL_OCTAVES];
+    for (int i = 0; i < count; ++i) {
+        values[i] = octaves[i].value;
+        dx[i] = octaves[i].dx;
+        dz[i] = octaves[i].dy;
+    }
+    return {
+        PerlinNoise::combineOctaves(std::span<const float>(values, count), persistence),
+        PerlinNoise::combineOctaves(std::span<const float>(dx, count), persistence),
+        PerlinNoise::combineOctaves(std::span<const float>(dz, count), persistence)
+    };
+}
+
+// Noise gradient with respect to the layer's input mapped to world units
+NoiseGradient toWorld(NoiseGradient n, float scale) {
+    return {n.value, n.dx * scale, n.dy * scale};
+}
+
+} // namespace
+
+struct BiomeGenerator::HeightLayers {
+    NoiseGradient continent[CONTINENT_OCTAVES];
+    NoiseGradient medium[MEDIUM_OCTAVES];
+    NoiseGradient detail[DETAIL_OCTAVES];
+};
+
+BiomeHeights BiomeGenerator::generateHeights(float x, float z, const PerlinNoise& heightNoise) const {
+    // Every biome samples the same octave stacks and differs only in how it
+    // weights them, so each lattice evaluation is done once
+    HeightLayers layers;
     
-    // Medium scale features (mountains/valleys)
-    float medium1 = heightNoise.octaveNoise(x * scale2, z * scale2, 0, 4, params1.roughness);
-    float medium2 = heightNoise.octaveNoise(x * scale2, z * scale2, 0, 4, params2.roughness);
+    // Large scale features (continents), shared by all biomes so blends
+    // between them stay continuous
+    for (int i = 0; i < CONTINENT_OCTAVES; ++i) {
+        float frequency = static_cast<float>(1 << i);
+        layers.continent[i] = toWorld(heightNoise.noise2DWithGradient(x * CONTINENT_SCALE * frequency, z * CONTINENT_SCALE * frequency),
+                                      CONTINENT_SCALE * frequency);
+    }
     
     // Small scale details
-    float detail1 = heightNoise.octaveNoise(x * scale1, z * scale1, 0, 6, params1.roughness);
-    float detail2 = heightNoise.octaveNoise(x * scale1, z * scale1, 0, 6, params2.roughness);
-    
-    // Combine scales with different weights
-    float baseHeight1 = continent1 * 0.5f + medium1 * 0.35f + detail1 * 0.15f;
-    float baseHeight2 = continent2 * 0.5f + medium2 * 0.35f + detail2 * 0.15f;
-    
-    // Add interesting features based on biome
-    if (primary == BiomeType::DESERT) {
-        // Add dune-like ridges
-        float dunes = std::sin(x * 0.05f) * std::sin(z * 0.05f) * 0.2f;
-        baseHeight1 += dunes;
-    } else if (primary == BiomeType::MOUNTAINS) {
-        // Add sharp peaks
-        float peaks = std::pow(std::abs(baseHeight1), 1.5f) * (baseHeight1 > 0 ? 1 : -1);
-        baseHeight1 = peaks;
+    for (int i = 0; i < DETAIL_OCTAVES; ++i) {
+        float frequency = static_cast<float>(1 << i);
+        layers.detail[i] = toWorld(heightNoise.noise2DWithGradient(x * DETAIL_SCALE * frequency, z * DETAIL_SCALE * frequency),
+                                   DETAIL_SCALE * frequency);
     }
     
-    float height1 = baseHeight1 * params1.heightScale;
-    float height2 = baseHeight2 * params2.heightScale;
+    // Medium scale features (mountains/valleys)
+    layers.medium[0] = toWorld(heightNoise.noise2DWithGradient(x * MEDIUM_SCALE, z * MEDIUM_SCALE), MEDIUM_SCALE);
+    std::copy(layers.detail, layers.detail + MEDIUM_OCTAVES - 1, layers.medium + 1);
     
-    return height1 * blend + height2 * (1.0f - blend);
+    return combineLayers(x, z, layers, climate.sampleWeights(x, z));
 }
 
-glm::vec3 BiomeGenerator::getColor(float x, float z, float height, const PerlinNoise& heightNoise) const {
-    BiomeType primary, secondary;
-    float blend = getBiomeBlend(x, z, primary, secondary);
+BiomeHeights BiomeGenerator::combineLayers(float x, float z, const HeightLayers& layers, const BiomeWeights& weights) const {
+    BiomeHeights result;
+    result.weights = weights;
+    
+    NoiseGradient continent = combineGradients(layers.continent, CONTINENT_OCTAVES, 0.4f);
     
-    auto getColorForBiome = [&](BiomeType type) -> glm::vec3 {
-        BiomeParams params = getBiomeParams(type);
+    for (int i = 0; i < weights.count; ++i) {
+        int id = weights.biomes[i];
+        float roughness = table.roughness[id];
         
-        if (height < params.colorThreshold1) {
-            return params.baseColor;
-        } else if (height < params.colorThreshold2) {
-            float t = (height - params.colorThreshold1) / (params.colorThreshold2 - params.colorThreshold1);
-            return params.baseColor * (1.0f - t) + params.midColor * t;
-        } else {
-            float t = std::min(1.0f, (height - params.colorThreshold2) / params.colorThreshold2);
-            return params.midColor * (1.0f - t) + params.peakColor * t;
+        // Combine scales with different weights
+        NoiseGradient medium = combineGradients(layers.medium, MEDIUM_OCTAVES, roughness);
+        NoiseGradient detail = combineGradients(layers.detail, DETAIL_OCTAVES, roughness);
+        float baseHeight = continent.value * 0.5f + medium.value * 0.35f + detail.value * 0.15f;
+        glm::vec2 baseGradient = glm::vec2(continent.dx, continent.dy) * 0.5f
+                               + glm::vec2(medium.dx, medium.dy) * 0.35f
+                               + glm::vec2(detail.dx, detail.dy) * 0.15f;
+        
+        // Add interesting features based on biome
+        if (table.feature[id] == BiomeFeature::DUNES) {
+            // Add dune-like ridges
+            float dunes = std::sin(x * 0.05f) * std::sin(z * 0.05f) * 0.2f;
+            baseHeight += dunes;
+            baseGradient += glm::vec2(std::cos(x * 0.05f) * std::sin(z * 0.05f),
+                                      std::sin(x * 0.05f) * std::cos(z * 0.05f)) * (0.05f * 0.2f);
+        } else if (table.feature[id] == BiomeFeature::PEAKS) {
+            // Add sharp peaks
+            float peaks = std::pow(std::abs(baseHeight), 1.5f) * (baseHeight > 0 ? 1 : -1);
+            baseGradient *= 1.5f * std::sqrt(std::abs(baseHeight));
+            baseHeight = peaks;
         }
+        
+        result.heights[i] = baseHeight * table.heightScale[id];
+        result.gradients[i] = baseGradient * table.heightScale[id];
+    }
+    return result;
+}
+
+BiomeSample BiomeGenerator::blendSample(const BiomeHeights& heights) const {
+    BiomeSample result = {0.0f, glm::vec2(0.0f), glm::vec3(0.0f)};
+    for (int i = 0; i < heights.weights.count; ++i) {
+        result.height += heights.heights[i] * heights.weights.weights[i];
+        result.gradient += heights.gradients[i] * heights.weights.weights[i];
+    }
+    // Colors depend on the final blended height, so they need a second pass
+    for (int i = 0; i < heights.weights.count; ++i) {
+        result.color += getColorForBiome(heights.weights.biomes[i], result.height) * heights.weights.weights[i];
+    }
+    return result;
+}
+
+BiomeSample BiomeGenerator::sample(float x, float z, const PerlinNoise& heightNoise) const {
+    return blendSample(generateHeights(x, z, heightNoise));
+}
+
+void BiomeGenerator::sampleGrid(std::span<const float> xs, std::span<const float> zs,
+                                const PerlinNoise& heightNoise, std::span<BiomeSample> out) const {
+    const std::size_t width = xs.size();
+    const std::size_t height = zs.size();
+    if (out.size() != width * height) {
+        throw std::invalid_argument("sampleGrid: out must hold xs.size() * zs.size() samples");
+    }
+    
+    // One single-octave grid per noise layer. The axes are scaled exactly
+    // as generateHeights() scales its coordinates, so values match.
+    std::vector<float> axisX(width), axisZ(height);
+    auto evaluateLayer = [&](float scale, float frequency, std::vector<NoiseGradient>& grid) {
+        for (std::size_t i = 0; i < width; ++i) axisX[i] = xs[i] * scale * frequency;
+        for (std::size_t j = 0; j < height; ++j) axisZ[j] = zs[j] * scale * frequency;
+        grid.resize(width * height);
+        heightNoise.evaluateGrid(axisX, axisZ, 1, 1.0f, std::span<NoiseGradient>(grid));
     };
     
-    glm::vec3 color1 = getColorForBiome(primary);
-    glm::vec3 color2 = getColorForBiome(secondary);
+    std::vector<NoiseGradient> continent[CONTINENT_OCTAVES];
+    std::vector<NoiseGradient> detail[DETAIL_OCTAVES];
+    std::vector<NoiseGradient> medium;
+    for (int i = 0; i < CONTINENT_OCTAVES; ++i) {
+        evaluateLayer(CONTINENT_SCALE, static_cast<float>(1 << i), continent[i]);
+    }
+    for (int i = 0; i < DETAIL_OCTAVES; ++i) {
+        evaluateLayer(DETAIL_SCALE, static_cast<float>(1 << i), detail[i]);
+    }
+    evaluateLayer(MEDIUM_SCALE, 1.0f, medium);
+    
+    for (std::size_t j = 0; j < height; ++j) {
+        for (std::size_t i = 0; i < width; ++i) {
+            const std::size_t index = j * width + i;
+            HeightLayers layers;
+            for (int o = 0; o < CONTINENT_OCTAVES; ++o) {
+                layers.continent[o] = toWorld(continent[o][index], CONTINENT_SCALE * static_cast<float>(1 << o));
+            }
+            for (int o = 0; o < DETAIL_OCTAVES; ++o) {
+                layers.detail[o] = toWorld(detail[o][index], DETAIL_SCALE * static_cast<float>(1 << o));
+            }
+            layers.medium[0] = toWorld(medium[index], MEDIUM_SCALE);
+            std::copy(layers.detail, layers.detail + MEDIUM_OCTAVES - 1, layers.medium + 1);
+            
+            out[index] = blendSample(combineLayers(xs[i], zs[j], layers, climate.sampleWeights(xs[i], zs[j])));
+        }
+    }
+}
+
+glm::vec3 BiomeGenerator::getColorForBiome(int id, float height) const {
+    const float threshold1 = table.colorThreshold1[id];
+    const float threshold2 = table.colorThreshold2[id];
+    
+    if (height < threshold1) {
+        return table.baseColor[id];
+    } else if (height < threshold2) {
+        float t = (height - threshold1) / (threshold2 - threshold1);
+        return table.baseColor[id] * (1.0f - t) + table.midColor[id] * t;
+    } else {
+        float t = std::min(1.0f, (height - threshold2) / threshold2);
+        return table.midColor[id] * (1.0f - t) + table.peakColor[id] * t;
+    }
+}
+
+glm::vec3 BiomeGenerator::getColor(float x, float z, float height, const PerlinNoise& heightNoise) const {
+    BiomeWeights weights = climate.sampleWeights(x, z);
     
-    return color1 * blend + color2 * (1.0f - blend);
+    glm::vec3 color(0.0f);
+    for (int i = 0; i < weights.count; ++i) {
+        color += getColorForBiome(weights.biomes[i], height) * weights.weights[i];
+    }
+    return color;
 }
\ No newline at end of file
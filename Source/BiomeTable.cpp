@@ -0,0 +1,111 @@
+#include "BiomeTable.h"
+#include <stdexcept>
+
+namespace {
+
+BiomeFeature parseFeature(const std::string& name) {
+    if (name.empty() || name == "none") return BiomeFeature::NONE;
+    if (name == "dunes") return BiomeFeature::DUNES;
+    if (name == "peaks") return BiomeFeature::PEAKS;
+    throw std::runtime_error("Unknown biome feature: " + name);
+}
+
+} // namespace
+
+BiomeTable::BiomeTable() {
+    addDefaults();
+}
+
+BiomeTable::BiomeTable(const std::map<std::string, BiomeConfig>& biomes) {
+    if (biomes.empty()) {
+        addDefaults();
+        return;
+    }
+    for (const auto& [name, biome] : biomes) {
+        add(name, biome);
+    }
+}
+
+void BiomeTable::addDefaults() {
+    // Climate centers sit either side of T = 0.3 and M = 0, so the nearest
+    // center reproduces the warm/cold, wet/dry quadrants
+    add("desert", {
+        25.0f,                                    // heightScale - rolling dunes
+        0.2f,                                     // roughness - smooth dunes
+        glm::vec3(0.96f, 0.87f, 0.5f),          // baseColor (bright sand)
+        glm::vec3(0.85f, 0.65f, 0.35f),         // midColor (orange sand)
+        glm::vec3(0.6f, 0.4f, 0.2f),            // peakColor (dark rock)
+        15.0f,                                    // colorThreshold1
+        25.0f,                                    // colorThreshold2
+        glm::vec2(1.3f, -1.0f),                 // climate (hot, dry)
+        "dunes"                                   // feature
+    });
+    add("forest", {
+        40.0f,                                    // heightScale - rolling hills
+        0.6f,                                     // roughness - varied terrain
+        glm::vec3(0.15f, 0.5f, 0.1f),           // baseColor (lush grass)
+        glm::vec3(0.08f, 0.3f, 0.05f),          // midColor (deep forest)
+        glm::vec3(0.4f, 0.35f, 0.25f),          // peakColor (earthy brown)
+        20.0f,                                    // colorThreshold1
+        35.0f,                                    // colorThreshold2
+        glm::vec2(1.3f, 1.0f),                  // climate (hot, wet)
+        "none"                                    // feature
+    });
+    add("mountains", {
+        120.0f,                                   // heightScale - tall peaks
+        0.9f,                                     // roughness - very rough
+        glm::vec3(0.4f, 0.35f, 0.3f),           // baseColor (dark rock)
+        glm::vec3(0.55f, 0.5f, 0.45f),          // midColor (granite)
+        glm::vec3(1.0f, 1.0f, 1.0f),            // peakColor (pure snow)
+        40.0f,                                    // colorThreshold1
+        70.0f,                                    // colorThreshold2
+        glm::vec2(-0.7f, -1.0f),                // climate (cold, dry)
+        "peaks"                                   // feature
+    });
+    add("tundra", {
+        30.0f,                                    // heightScale - low hills
+        0.5f,                                     // roughness - moderate
+        glm::vec3(0.35f, 0.45f, 0.35f),         // baseColor (arctic grass)
+        glm::vec3(0.75f, 0.8f, 0.85f),          // midColor (permafrost)
+        glm::vec3(0.95f, 0.97f, 1.0f),          // peakColor (glacial ice)
+        12.0f,                                    // colorThreshold1
+        22.0f,                                    // colorThreshold2
+        glm::vec2(-0.7f, 1.0f),                 // climate (cold, wet)
+        "none"                                    // feature
+    });
+}
+
+void BiomeTable::add(const std::string& name, const BiomeConfig& biome) {
+    names.push_back(name);
+    heightScale.push_back(biome.heightScale);
+    roughness.push_back(biome.roughness);
+    baseColor.push_back(biome.baseColor);
+    midColor.push_back(biome.midColor);
+    peakColor.push_back(biome.peakColor);
+    colorThreshold1.push_back(biome.colorThreshold1);
+    colorThreshold2.push_back(biome.colorThreshold2);
+    climate.push_back(biome.climate);
+    feature.push_back(parseFeature(biome.feature));
+}
+
+int BiomeTable::findId(const std::string& name) const {
+    for (int id = 0; id < size(); ++id) {
+        if (names[id] == name) return id;
+    }
+    return -1;
+}
+
+int BiomeTable::classify(float temperature, float moisture) const {
+    int nearest = 0;
+    float nearestDistance = 0.0f;
+    for (int id = 0; id < size(); ++id) {
+        float dt = temperature - climate[id].x;
+        float dm = moisture - climate[id].y;
+        float distance = dt * dt + dm * dm;
+        if (id == 0 || distance < nearestDistance) {
+            nearest = id;
+            nearestDistance = distance;
+        }
+    }
+    return nearest;
+}
@@ -0,0 +1,269 @@
+#include "ChunkArena.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+
+namespace {
+
+// Adaptive index ranges start small; grids only use the shared patterns
+constexpr std::size_t INITIAL_INDEX_CAPACITY = 1 << 16;
+
+} // namespace
+
+ChunkArena::ChunkArena(VertexFormat format, std::size_t vertexCapacity, const ChunkIndexCache& indexCache, bool morphing)
+    : format(format), vertexStride(vertexSize(format)), indexType(indexCache.getIndexType()),
+      indexSize(indexType == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(unsigned int)),
+      sharedIndexCount(indexCache.getBytes() / indexSize),
+      multiDrawIndirect(GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance)),
+      perDrawAttributes(format == VertexFormat::COMPACT || morphing), vertices(vertexCapacity),
+      indices(INITIAL_INDEX_CAPACITY), VAO(0), vertexBuffer(0), indexBuffer(0), vertexTexture(0), attributeBuffer(0),
+      commandBuffer(0), relocations(0) {
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &vertexBuffer);
+    glGenBuffers(1, &indexBuffer);
+    glGenBuffers(1, &attributeBuffer);
+    glGenBuffers(1, &commandBuffer);
+    if (morphing) {
+        glGenTextures(1, &vertexTexture);
+    }
+    
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertices.getCapacity() * vertexStride, nullptr, GL_STATIC_DRAW);
+    
+    // The shared patterns keep the byte offsets ChunkIndexCache gave them
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, (sharedIndexCount + indices.getCapacity()) * indexSize, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, indexCache.getBuffer());
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sharedIndexCount * indexSize);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    
+    bindBuffers();
+}
+
+ChunkArena::~ChunkArena() {
+    if (vertexTexture != 0) {
+        glDeleteTextures(1, &vertexTexture);
+    }
+    glDeleteBuffers(1, &commandBuffer);
+    glDeleteBuffers(1, &attributeBuffer);
+    glDeleteBuffers(1, &indexBuffer);
+    glDeleteBuffers(1, &vertexBuffer);
+    glDeleteVertexArrays(1, &VAO);
+}
+
+ChunkArena::Handle ChunkArena::allocateVertices(std::size_t count) {
+    return allocate(vertices, count, true);
+}
+
+void ChunkArena::releaseVertices(Handle& handle) {
+    vertices.release(handle);
+    handle = ArenaAllocator::NONE;
+}
+
+ChunkArena::Handle ChunkArena::uploadIndices(std::span<const unsigned int> data) {
+    Handle handle = allocate(indices, data.size(), false);
+    const std::size_t offset = static_cast<std::size_t>(getFirstIndex(handle)) * indexSize;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, indexBuffer);
+    if (indexType == GL_UNSIGNED_SHORT) {
+        std::vector<std::uint16_t> shortIndices(data.begin(), data.end());
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, shortIndices.size() * sizeof(std::uint16_t), shortIndices.data());
+    } else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, offset, data.size() * sizeof(unsigned int), data.data());
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    return handle;
+}
+
+void ChunkArena::releaseIndices(Handle& handle) {
+    indices.release(handle);
+    handle = ArenaAllocator::NONE;
+}
+
+ChunkArena::Handle ChunkArena::allocate(ArenaAllocator& allocator, std::size_t size, bool vertexRange) {
+    Handle handle = allocator.allocate(size);
+    if (handle != ArenaAllocator::NONE) {
+        return handle;
+    }
+    
+    // Out of room, or too fragmented: compact into a fresh buffer, doubling
+    // it until a quarter stays free so this does not happen again next chunk
+    std::size_t capacity = std::max<std::size_t>(allocator.getCapacity(), 1);
+    const std::size_t needed = allocator.getUsed() + size;
+    while (needed > capacity - capacity / 4) {
+        capacity *= 2;
+    }
+    std::vector<ArenaAllocator::Move> moves = allocator.compact();
+    allocator.grow(capacity);
+    if (vertexRange) {
+        relocate(vertexBuffer, vertexStride, 0, moves, capacity * vertexStride);
+    } else {
+        relocate(indexBuffer, indexSize, sharedIndexCount * indexSize, moves, (sharedIndexCount + capacity) * indexSize);
+    }
+    bindBuffers();
+    relocations++;
+    return allocator.allocate(size);
+}
+
+void ChunkArena::relocate(GLuint& buffer, std::size_t unitSize, std::size_t keptBytes,
+                          const std::vector<ArenaAllocator::Move>& moves, std::size_t capacityBytes) {
+    // Copies within one buffer must not overlap, so the packed layout goes
+    // into a new one; the GPU does the copying
+    GLuint fresh;
+    glGenBuffers(1, &fresh);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, fresh);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacityBytes, nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+    if (keptBytes > 0) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keptBytes);
+    }
+    for (const ArenaAllocator::Move& move : moves) {
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, keptBytes + move.from * unitSize,
+                            keptBytes + move.to * unitSize, move.size * unitSize);
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+    buffer = fresh;
+}
+
+void ChunkArena::bindBuffers() {
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    if (format == VertexFormat::COMPACT) {
+        // Height and grid index stay integers; the shader scales them with the chunk attributes
+        glVertexAttribIPointer(4, 2, GL_UNSIGNED_SHORT, sizeof(CompactTerrainVertex), (void*)offsetof(CompactTerrainVertex, height));
+        glEnableVertexAttribArray(4);
+        
+        glVertexAttribPointer(5, 2, GL_BYTE, GL_TRUE, sizeof(CompactTerrainVertex), (void*)offsetof(CompactTerrainVertex, normal));
+        glEnableVertexAttribArray(5);
+        
+        glVertexAttribIPointer(6, 1, GL_UNSIGNED_SHORT, sizeof(CompactTerrainVertex), (void*)offsetof(CompactTerrainVertex, color));
+        glEnableVertexAttribArray(6);
+    } else {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), (void*)offsetof(TerrainVertex, position));
+        glEnableVertexAttribArray(0);
+        
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), (void*)offsetof(TerrainVertex, normal));
+        glEnableVertexAttribArray(1);
+        
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(TerrainVertex), (void*)offsetof(TerrainVertex, texCoords));
+        glEnableVertexAttribArray(2);
+        
+        glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TerrainVertex), (void*)offsetof(TerrainVertex, color));
+        glEnableVertexAttribArray(3);
+    }
+    
+    // Each indirect command's base instance picks its chunk's attributes;
+    // without those they are set as constant attributes per draw instead
+    if (multiDrawIndirect) {
+        glBindBuffer(GL_ARRAY_BUFFER, attributeBuffer);
+        glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(ChunkAttributes), (void*)offsetof(ChunkAttributes, originX));
+        glVertexAttribIPointer(8, 3, GL_UNSIGNED_INT, sizeof(ChunkAttributes), (void*)offsetof(ChunkAttributes, base));
+        glVertexAttribPointer(9, 2, GL_FLOAT, GL_FALSE, sizeof(ChunkAttributes), (void*)offsetof(ChunkAttributes, morphStart));
+        for (GLuint location = 7; location <= 9; ++location) {
+            glEnableVertexAttribArray(location);
+            glVertexAttribDivisor(location, 1);
+        }
+    }
+    
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBindVertexArray(0);
+    
+    // Morphing reads neighbouring vertex heights straight from the arena
+    if (vertexTexture != 0) {
+        GLint maxTexels = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        if (vertices.getCapacity() * vertexStride / 4 > static_cast<std::size_t>(maxTexels)) {
+            std::cerr << "Chunk arena exceeds the buffer texture size limit, distant chunks will not morph correctly" << std::endl;
+        }
+        glBindTexture(GL_TEXTURE_BUFFER, vertexTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, vertexBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+}
+
+int ChunkArena::draw(std::span<const Draw> draws) {
+    if (draws.empty()) {
+        return 0;
+    }
+    
+    // Lists and strips cannot share a call; with adaptive meshes over strip
+    // patterns there are both
+    sorted.assign(draws.begin(), draws.end());
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Draw& a, const Draw& b) { return a.mode < b.mode; });
+    
+    glBindVertexArray(VAO);
+    if (vertexTexture != 0) {
+        glBindTexture(GL_TEXTURE_BUFFER, vertexTexture);
+    }
+    
+    int calls = 0;
+    if (multiDrawIndirect) {
+        attributes.clear();
+        commands.clear();
+        for (const Draw& draw : sorted) {
+            commands.push_back({draw.count, 1, draw.firstIndex, static_cast<GLint>(draw.attributes.base),
+                                static_cast<GLuint>(attributes.size())});
+            attributes.push_back(draw.attributes);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, attributeBuffer);
+        glBufferData(GL_ARRAY_BUFFER, attributes.size() * sizeof(ChunkAttributes), attributes.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawCommand), commands.data(), GL_STREAM_DRAW);
+    }
+    
+    std::size_t begin = 0;
+    while (begin < sorted.size()) {
+        const GLenum mode = sorted[begin].mode;
+        std::size_t end = begin + 1;
+        while (end < sorted.size() && sorted[end].mode == mode) {
+            ++end;
+        }
+        
+        if (multiDrawIndirect) {
+            glMultiDrawElementsIndirect(mode, indexType, (void*)(begin * sizeof(DrawCommand)), static_cast<GLsizei>(end - begin), 0);
+            calls++;
+        } else if (!perDrawAttributes) {
+            // Full vertices are already in world space and need nothing per chunk
+            counts.clear();
+            offsets.clear();
+            baseVertices.clear();
+            for (std::size_t i = begin; i < end; ++i) {
+                counts.push_back(static_cast<GLsizei>(sorted[i].count));
+                offsets.push_back((const void*)(sorted[i].firstIndex * indexSize));
+                baseVertices.push_back(static_cast<GLint>(sorted[i].attributes.base));
+            }
+            glMultiDrawElementsBaseVertex(mode, counts.data(), indexType, offsets.data(), static_cast<GLsizei>(counts.size()),
+                                          baseVertices.data());
+            calls++;
+        } else {
+            // GL 3.3 has no base instance to pick per-draw attributes with, so
+            // each chunk sets them as constants; the VAO still stays bound
+            for (std::size_t i = begin; i < end; ++i) {
+                const ChunkAttributes& chunk = sorted[i].attributes;
+                glVertexAttrib4f(7, chunk.originX, chunk.originZ, chunk.heightBase, chunk.heightStep);
+                glVertexAttribI4ui(8, chunk.base, chunk.pinnedEdges, chunk.resolution, 0);
+                glVertexAttrib4f(9, chunk.morphStart, chunk.morphEnd, 0.0f, 1.0f);
+                glDrawElementsBaseVertex(mode, static_cast<GLsizei>(sorted[i].count), indexType,
+                                         (void*)(sorted[i].firstIndex * indexSize), static_cast<GLint>(chunk.base));
+                calls++;
+            }
+        }
+        begin = end;
+    }
+    
+    if (multiDrawIndirect) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+    glBindVertexArray(0);
+    return calls;
+}
+
+std::size_t ChunkArena::getBytes() const {
+    return vertices.getCapacity() * vertexStride + (sharedIndexCount + indices.getCapacity()) * indexSize;
+}
+
+std::size_t ChunkArena::getUsedBytes() const {
+    return vertices.getUsed() * vertexStride + (sharedIndexCount + indices.getUsed()) * indexSize;
+}
\ No newline at end of file
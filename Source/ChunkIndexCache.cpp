@@ -0,0 +1,96 @@
+#include "ChunkIndexCache.h"
+#include "GridIndices.h"
+#include "VertexCache.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+
+// Forsyth order, unless the grid's rows already fit in the vertex cache and
+// row order measures better
+std::vector<unsigned int> cacheOptimizedTriangles(int vertexResolution, unsigned int stitchedEdges) {
+    std::vector<unsigned int> rows = buildGridTriangles(vertexResolution, stitchedEdges);
+    std::vector<unsigned int> optimized = optimizeVertexCache(rows, static_cast<std::size_t>(vertexResolution) * vertexResolution);
+    if (measureVertexCache(optimized, IndexEncoding::TRIANGLES).misses < measureVertexCache(rows, IndexEncoding::TRIANGLES).misses) {
+        return optimized;
+    }
+    return rows;
+}
+
+} // namespace
+
+ChunkIndexCache::ChunkIndexCache(int resolution, int lodLevels, IndexEncoding encoding)
+    : encoding(encoding), indexType(GL_UNSIGNED_INT) {
+    // 16-bit strips whenever every vertex index stays below the 0xFFFF
+    // restart index; LOD 0 has the most vertices
+    int largest = vertexResolution(resolution, 0);
+    if (encoding == IndexEncoding::STRIPS && largest * largest <= 0xFFFF) {
+        indexType = GL_UNSIGNED_SHORT;
+    }
+    
+    const std::size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(unsigned int);
+    std::vector<unsigned int> indices;
+    for (int lod = 0; lod < std::max(lodLevels, 1); ++lod) {
+        int size = vertexResolution(resolution, lod);
+        
+        // All edge variants back to back; a grid too small to stitch reuses
+        // the unstitched list for every mask
+        const std::size_t first = buffers.size();
+        for (unsigned int edges = 0; edges < EDGE_MASK_COUNT; ++edges) {
+            IndexBuffer entry;
+            entry.vertexResolution = size;
+            entry.offset = indices.size() * indexSize;
+            entry.mode = encoding == IndexEncoding::STRIPS ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+            entry.type = indexType;
+            if (edges > 0 && !canStitchEdges(size)) {
+                entry.offset = buffers[first].offset;
+                entry.count = buffers[first].count;
+                buffers.push_back(entry);
+                continue;
+            }
+            
+            // Ordered for the post-transform vertex cache once here, so every
+            // chunk draws the cache-friendly order for free
+            std::vector<unsigned int> variant = encoding == IndexEncoding::STRIPS
+                ? buildGridStrips(size, getRestartIndex(), edges, STRIP_BAND_CELLS)
+                : cacheOptimizedTriangles(size, edges);
+            entry.count = static_cast<GLsizei>(variant.size());
+            indices.insert(indices.end(), variant.begin(), variant.end());
+            buffers.push_back(entry);
+        }
+    }
+    
+    // Element array bindings belong to the bound VAO, so upload through a
+    // neutral target; users attach the buffer to their own VAOs
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    if (indexType == GL_UNSIGNED_SHORT) {
+        std::vector<std::uint16_t> shortIndices(indices.begin(), indices.end());
+        glBufferData(GL_COPY_WRITE_BUFFER, shortIndices.size() * sizeof(std::uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+    } else {
+        glBufferData(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    for (IndexBuffer& entry : buffers) {
+        entry.buffer = buffer;
+    }
+    bufferBytes = indices.size() * indexSize;
+}
+
+ChunkIndexCache::~ChunkIndexCache() {
+    glDeleteBuffers(1, &buffer);
+}
+
+const ChunkIndexCache::IndexBuffer& ChunkIndexCache::get(int lod, unsigned int stitchedEdges) const {
+    int level = std::clamp(lod, 0, getLodLevels() - 1);
+    return buffers[level * EDGE_MASK_COUNT + (stitchedEdges % EDGE_MASK_COUNT)];
+}
+
+unsigned int ChunkIndexCache::stitchedEdges(int lod, int northLOD, int southLOD, int eastLOD, int westLOD) {
+    unsigned int edges = 0;
+    if (northLOD > lod) edges |= EDGE_NORTH;
+    if (southLOD > lod) edges |= EDGE_SOUTH;
+    if (eastLOD > lod) edges |= EDGE_EAST;
+    if (westLOD > lod) edges |= EDGE_WEST;
+    return edges;
+}
\ No newline at end of file
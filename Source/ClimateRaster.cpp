@@ -0,0 +1,252 @@
+#include "ClimateRaster.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Climate noise frequency and the offset that decorrelates moisture from temperature
+constexpr float CLIMATE_FREQUENCY = 0.002f;
+constexpr float MOISTURE_OFFSET = 1000.0f;
+
+// Stand-in for "no site" in the distance transform; finite so the envelope
+// arithmetic never sees inf - inf
+constexpr double FAR_AWAY = 1e10;
+
+int floorDiv(int a, int b) {
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+// Exact 1D squared Euclidean distance transform (Felzenszwalb & Huttenlocher)
+// of f into d, with n samples at a stride. v and z are scratch of n and n + 1.
+void distanceTransform1D(const double* f, double* d, int n, int stride, int* v, double* z) {
+    int k = 0;
+    v[0] = 0;
+    z[0] = -FAR_AWAY;
+    z[1] = FAR_AWAY;
+    for (int q = 1; q < n; ++q) {
+        // Intersection of the parabola rooted at q with the lowest one so far;
+        // z[0] = -FAR_AWAY guarantees the pop loop stops at k = 0
+        auto intersect = [&](int p) {
+            return ((f[q * stride] + q * q) - (f[p * stride] + p * p)) / (2.0 * (q - p));
+        };
+        double s = intersect(v[k]);
+        while (s <= z[k]) {
+            --k;
+            s = intersect(v[k]);
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = FAR_AWAY;
+    }
+    
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q) ++k;
+        int p = v[k];
+        d[q * stride] = (q - p) * (q - p) + f[p * stride];
+    }
+}
+
+} // namespace
+
+ClimateRaster::ClimateRaster(unsigned int seed, int biomeCount, Classifier classifier)
+    : noise(seed), biomeCount(biomeCount), classifier(std::move(classifier)) {
+    if (biomeCount <= 0) {
+        throw std::invalid_argument("ClimateRaster: biomeCount must be positive");
+    }
+}
+
+float ClimateRaster::temperatureAt(float x, float z) const {
+    return noise.octaveNoise2D(x * CLIMATE_FREQUENCY, z * CLIMATE_FREQUENCY, 3, 0.5f);
+}
+
+float ClimateRaster::moistureAt(float x, float z) const {
+    return noise.octaveNoise2D(x * CLIMATE_FREQUENCY + MOISTURE_OFFSET, z * CLIMATE_FREQUENCY + MOISTURE_OFFSET, 3, 0.5f);
+}
+
+ClimateRaster::Lookup ClimateRaster::locate(float x, float z) const {
+    float gx = x / CELL_SIZE;
+    float gz = z / CELL_SIZE;
+    float cellX = std::floor(gx);
+    float cellZ = std::floor(gz);
+    
+    glm::ivec2 cell(static_cast<int>(cellX), static_cast<int>(cellZ));
+    glm::ivec2 tileCoord(floorDiv(cell.x, TILE_CELLS), floorDiv(cell.y, TILE_CELLS));
+    glm::ivec2 local = cell - tileCoord * TILE_CELLS;
+    
+    Lookup lookup;
+    lookup.tile = getTile(tileCoord);
+    lookup.node = local.y * (TILE_CELLS + 1) + local.x;
+    lookup.fx = gx - cellX;
+    lookup.fz = gz - cellZ;
+    return lookup;
+}
+
+ClimateSample ClimateRaster::sample(float x, float z) const {
+    Lookup lookup = locate(x, z);
+    const int stride = TILE_CELLS + 1;
+    const float fx = lookup.fx;
+    const float fz = lookup.fz;
+    
+    auto interpolate = [&](const std::vector<float>& field, float& value, glm::vec2& gradient) {
+        float v00 = field[lookup.node];
+        float v10 = field[lookup.node + 1];
+        float v01 = field[lookup.node + stride];
+        float v11 = field[lookup.node + stride + 1];
+        
+        float south = v00 + fx * (v10 - v00);
+        float north = v01 + fx * (v11 - v01);
+        value = south + fz * (north - south);
+        gradient.x = ((v10 - v00) + fz * ((v11 - v01) - (v10 - v00))) / CELL_SIZE;
+        gradient.y = (north - south) / CELL_SIZE;
+    };
+    
+    ClimateSample result;
+    interpolate(lookup.tile->temperature, result.temperature, result.temperatureGradient);
+    interpolate(lookup.tile->moisture, result.moisture, result.moistureGradient);
+    return result;
+}
+
+BiomeWeights ClimateRaster::sampleWeights(float x, float z) const {
+    Lookup lookup = locate(x, z);
+    const int stride = TILE_CELLS + 1;
+    const int plane = stride * stride;
+    const float w00 = (1.0f - lookup.fx) * (1.0f - lookup.fz);
+    const float w10 = lookup.fx * (1.0f - lookup.fz);
+    const float w01 = (1.0f - lookup.fx) * lookup.fz;
+    const float w11 = lookup.fx * lookup.fz;
+    
+    BiomeWeights result = {};
+    float total = 0.0f;
+    for (int biome = 0; biome < biomeCount; ++biome) {
+        const std::uint8_t* w = lookup.tile->weights.data() + biome * plane + lookup.node;
+        float weight = w[0] * w00 + w[1] * w10 + w[stride] * w01 + w[stride + 1] * w11;
+        if (weight <= 0.0f) continue;
+        
+        // Keep the largest MAX_BIOMES, sorted descending
+        int slot = result.count < BiomeWeights::MAX_BIOMES ? result.count++ : BiomeWeights::MAX_BIOMES;
+        if (slot == BiomeWeights::MAX_BIOMES) {
+            if (weight <= result.weights[slot - 1]) continue;
+            total -= result.weights[--slot];
+        }
+        while (slot > 0 && result.weights[slot - 1] < weight) {
+            result.biomes[slot] = result.biomes[slot - 1];
+            result.weights[slot] = result.weights[slot - 1];
+            --slot;
+        }
+        result.biomes[slot] = biome;
+        result.weights[slot] = weight;
+        total += weight;
+    }
+    
+    for (int i = 0; i < result.count; ++i) {
+        result.weights[i] /= total;
+    }
+    return result;
+}
+
+std::size_t ClimateRaster::tileCount() const {
+    std::lock_guard<std::mutex> lock(tileMutex);
+    return tiles.size();
+}
+
+std::shared_ptr<const ClimateRaster::Tile> ClimateRaster::getTile(glm::ivec2 tileCoord) const {
+    {
+        std::lock_guard<std::mutex> lock(tileMutex);
+        auto it = tiles.find(tileCoord);
+        if (it != tiles.end()) {
+            return it->second;
+        }
+    }
+    
+    // Build outside the lock; if another thread raced us to the same tile,
+    // keep whichever landed first (both are identical)
+    std::shared_ptr<const Tile> built = buildTile(tileCoord);
+    
+    std::lock_guard<std::mutex> lock(tileMutex);
+    auto [it, inserted] = tiles.emplace(tileCoord, built);
+    if (inserted) {
+        tileOrder.push_back(tileCoord);
+        while (tiles.size() > MAX_TILES) {
+            tiles.erase(tileOrder.front());
+            tileOrder.pop_front();
+        }
+    }
+    return it->second;
+}
+
+std::shared_ptr<const ClimateRaster::Tile> ClimateRaster::buildTile(glm::ivec2 tileCoord) const {
+    const int nodes = TILE_CELLS + 1;
+    const int extended = nodes + 2 * APRON_CELLS;
+    
+    // Node coordinates are computed from the global node index so tiles
+    // agree exactly on their shared edges. The climate is evaluated over
+    // the apron too so the distance transform sees neighbouring regions.
+    std::vector<float> xs(extended), zs(extended), moistureXs(extended), moistureZs(extended);
+    for (int i = 0; i < extended; ++i) {
+        float worldX = (tileCoord.x * TILE_CELLS + i - APRON_CELLS) * CELL_SIZE;
+        float worldZ = (tileCoord.y * TILE_CELLS + i - APRON_CELLS) * CELL_SIZE;
+        xs[i] = worldX * CLIMATE_FREQUENCY;
+        zs[i] = worldZ * CLIMATE_FREQUENCY;
+        moistureXs[i] = xs[i] + MOISTURE_OFFSET;
+        moistureZs[i] = zs[i] + MOISTURE_OFFSET;
+    }
+    
+    std::vector<float> temperature(extended * extended), moisture(extended * extended);
+    noise.evaluateGrid(xs, zs, 3, 0.5f, std::span<float>(temperature));
+    noise.evaluateGrid(moistureXs, moistureZs, 3, 0.5f, std::span<float>(moisture));
+    
+    std::vector<int> classes(extended * extended);
+    for (std::size_t i = 0; i < classes.size(); ++i) {
+        classes[i] = std::clamp(classifier(temperature[i], moisture[i]), 0, biomeCount - 1);
+    }
+    
+    auto tile = std::make_shared<Tile>();
+    tile->temperature.resize(nodes * nodes);
+    tile->moisture.resize(nodes * nodes);
+    tile->weights.resize(static_cast<std::size_t>(biomeCount) * nodes * nodes);
+    for (int z = 0; z < nodes; ++z) {
+        for (int x = 0; x < nodes; ++x) {
+            int source = (z + APRON_CELLS) * extended + (x + APRON_CELLS);
+            tile->temperature[z * nodes + x] = temperature[source];
+            tile->moisture[z * nodes + x] = moisture[source];
+        }
+    }
+    
+    // Squared distance, in cells, from every node to the nearest node of
+    // each biome: two separable 1D passes per biome
+    std::vector<double> field(extended * extended), distance(extended * extended);
+    std::vector<int> v(extended);
+    std::vector<double> envelope(extended + 1);
+    
+    for (int biome = 0; biome < biomeCount; ++biome) {
+        bool present = false;
+        for (std::size_t i = 0; i < classes.size(); ++i) {
+            field[i] = classes[i] == biome ? 0.0 : FAR_AWAY;
+            present = present || classes[i] == biome;
+        }
+        if (!present) continue; // Weights stay zero
+        
+        for (int row = 0; row < extended; ++row) {
+            distanceTransform1D(field.data() + row * extended, distance.data() + row * extended, extended, 1, v.data(), envelope.data());
+        }
+        for (int column = 0; column < extended; ++column) {
+            distanceTransform1D(distance.data() + column, field.data() + column, extended, extended, v.data(), envelope.data());
+        }
+        
+        // Region boundaries lie half a cell past the last node, and the
+        // weight falls linearly to zero BLEND_DISTANCE beyond them
+        std::uint8_t* weights = tile->weights.data() + static_cast<std::size_t>(biome) * nodes * nodes;
+        for (int z = 0; z < nodes; ++z) {
+            for (int x = 0; x < nodes; ++x) {
+                double squared = field[(z + APRON_CELLS) * extended + (x + APRON_CELLS)];
+                float toBoundary = std::max(0.0f, static_cast<float>(std::sqrt(squared)) * CELL_SIZE - 0.5f * CELL_SIZE);
+                float weight = std::max(0.0f, 1.0f - toBoundary / BLEND_DISTANCE);
+                weights[z * nodes + x] = static_cast<std::uint8_t>(std::lround(weight * 255.0f));
+            }
+        }
+    }
+    return tile;
+}
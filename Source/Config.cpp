@@ -11,6 +11,10 @@ Config& Config::getInstance() {
     return *instance;
 }
 
+glm::vec2 Config::parseVec2(const json& arr) {
+    return glm::vec2(arr[0].get<float>(), arr[1].get<float>());
+}
+
 glm::vec3 Config::parseVec3(const json& arr) {
     return glm::vec3(arr[0].get<float>(), arr[1].get<float>(), arr[2].get<float>());
 }
@@ -65,7 +69,17 @@ void Config::loadFromFile(const std::string& filename) {
     terrain.lodDistances = t["lodDistances"].get<std::vector<float>>();
     terrain.heightNoiseSeed = t["heightNoiseSeed"];
     terrain.biomeNoiseSeed = t["biomeNoiseSeed"];
-    terrain.maxChunkPoolSize = t["maxChunkPoolSize"];
+    terrain.vertexFormat = parseVertexFormat(t["vertexFormat"].get<std::string>());
+    terrain.indexEncoding = parseIndexEncoding(t["indexEncoding"].get<std::string>());
+    terrain.keepCpuMeshes = t["keepCpuMeshes"];
+    terrain.normalSource = parseNormalSource(t["normalSource"].get<std::string>());
+    terrain.lodMode = parseLodMode(t["lodMode"].get<std::string>());
+    terrain.lodMorphRegion = t["lodMorphRegion"];
+    terrain.meshMode = parseMeshMode(t["meshMode"].get<std::string>());
+    terrain.adaptiveMaxError = t["adaptiveMaxError"];
+    terrain.uploadRingMegabytes = t["uploadRingMegabytes"];
+    terrain.chunkArenaMegabytes = t["chunkArenaMegabytes"];
+    terrain.horizonCulling = t["horizonCulling"];
     
     // Parse biomes
     auto& b = configData["biomes"];
@@ -78,6 +92,8 @@ void Config::loadFromFile(const std::string& filename) {
         biome.peakColor = parseVec3(biomeData["peakColor"]);
         biome.colorThreshold1 = biomeData["colorThreshold1"];
         biome.colorThreshold2 = biomeData["colorThreshold2"];
+        biome.climate = parseVec2(biomeData["climate"]);
+        biome.feature = biomeData["feature"];
         biomes[name] = biome;
     }
     
@@ -1,24 +1,122 @@
 #include "DynamicTerrain.h"
 #include <algorithm>
-#include <execution>
+#include <thread>
 #include <iostream>
 #include <climits>
 #include <glm/gtc/matrix_transform.hpp>
 
+namespace {
+
+// Texture units for TerrainChunk's vertex buffer texture and the height
+// tile arrays; Water uses 0-3
+constexpr int MORPH_TEXTURE_UNIT = 4;
+constexpr int HEIGHT_TILE_TEXTURE_UNIT = 5;
+
+} // namespace
+
 DynamicTerrain::DynamicTerrain() {
     Config& config = Config::getInstance();
     heightNoise = std::make_unique<PerlinNoise>(config.terrain.heightNoiseSeed);
-    biomeGen = std::make_unique<BiomeGenerator>(config.terrain.biomeNoiseSeed);
+    biomeGen = std::make_unique<BiomeGenerator>(config.terrain.biomeNoiseSeed, BiomeTable(config.biomes));
     lastPlayerChunk = glm::ivec2(INT_MAX, INT_MAX);
+    lodCenter = glm::vec3(0.0f);
+    
+    // Compact vertices address the grid with a 16-bit index
+    meshOptions.vertexFormat = config.terrain.vertexFormat;
+    if (meshOptions.vertexFormat == VertexFormat::COMPACT && config.terrain.chunkResolution * config.terrain.chunkResolution > 65536) {
+        std::cerr << "Chunk resolution " << config.terrain.chunkResolution
+                  << " is too large for compact vertices, using the full format" << std::endl;
+        meshOptions.vertexFormat = VertexFormat::FULL;
+    }
+    
+    horizonCulling = config.terrain.horizonCulling;
+    meshOptions.normalSource = config.terrain.normalSource;
+    meshOptions.keepCpuMesh = config.terrain.keepCpuMeshes;
+    
+    // Adaptive meshes need a 2^n + 1 grid and their own index buffers, which
+    // the instanced height tiles cannot have. Their vertices are not on the
+    // coarser grid either, so they switch LOD without morphing.
+    meshOptions.meshMode = config.terrain.meshMode;
+    meshOptions.adaptiveMaxError = config.terrain.adaptiveMaxError;
+    lodMode = config.terrain.lodMode;
+    if (meshOptions.meshMode == MeshMode::ADAPTIVE) {
+        if (meshOptions.vertexFormat == VertexFormat::HEIGHT_TILE || !canBuildAdaptiveMesh(config.terrain.chunkResolution)) {
+            std::cerr << "Adaptive meshes need a 2^n + 1 chunk resolution and a vertex buffer, using the grid" << std::endl;
+            meshOptions.meshMode = MeshMode::GRID;
+        } else if (lodMode == LodMode::MORPH) {
+            std::cerr << "Adaptive meshes cannot morph, using discrete LODs" << std::endl;
+            lodMode = LodMode::DISCRETE;
+        }
+    }
+    if (meshOptions.vertexFormat == VertexFormat::HEIGHT_TILE) {
+        heightTiles = std::make_unique<HeightTileStore>(config.terrain.chunkResolution, config.terrain.chunkSize,
+                                                        config.terrain.maxLodLevels);
+        meshOptions.heightTiles = heightTiles.get();
+    } else {
+        // Room for at least a couple of the largest chunks, so one upload
+        // never waits on the copy just before it
+        std::size_t largestChunk = static_cast<std::size_t>(config.terrain.chunkResolution) * config.terrain.chunkResolution *
+                                   vertexSize(meshOptions.vertexFormat);
+        uploadRing = std::make_unique<GeometryUploadRing>(
+            std::max<std::size_t>(static_cast<std::size_t>(config.terrain.uploadRingMegabytes) << 20, 4 * largestChunk));
+        if (!uploadRing->isPersistent()) {
+            std::cerr << "ARB_buffer_storage is not available, chunk uploads use glBufferSubData" << std::endl;
+        }
+        meshOptions.uploadRing = uploadRing.get();
+    }
+    for (int lod = 0; lod < config.terrain.maxLodLevels; ++lod) {
+        morphRanges.push_back(lodMorphRange(config.terrain.lodDistances, config.terrain.maxLodLevels, lod,
+                                            config.terrain.chunkSize, config.terrain.lodMorphRegion));
+        if (lodMode == LodMode::MORPH && lod + 1 < config.terrain.maxLodLevels && !morphRanges.back().morphs()) {
+            std::cerr << "LOD band " << lod << " is too narrow to morph, it will pop" << std::endl;
+        }
+    }
+    indexCache = std::make_unique<ChunkIndexCache>(config.terrain.chunkResolution, config.terrain.maxLodLevels,
+                                                   config.terrain.indexEncoding);
+    
+    // Every vertex buffer chunk lives in one arena so a pass is a single
+    // multi-draw; morphing reads neighbouring heights back from it
+    if (!heightTiles) {
+        std::size_t arenaVertices = (static_cast<std::size_t>(config.terrain.chunkArenaMegabytes) << 20) /
+                                    vertexSize(meshOptions.vertexFormat);
+        arena = std::make_unique<ChunkArena>(meshOptions.vertexFormat, arenaVertices, *indexCache, lodMode == LodMode::MORPH);
+        if (!arena->usesMultiDrawIndirect()) {
+            std::cerr << "Multi-draw indirect is not available, using glMultiDrawElementsBaseVertex" << std::endl;
+        }
+        meshOptions.arena = arena.get();
+    }
+    
+    // Stitching assumes each LOD's grid is a subset of the finer one and
+    // that neighbours differ by at most one level
+    int cells = config.terrain.chunkResolution - 1;
+    if (cells < 1 || (cells & (cells - 1)) != 0) {
+        std::cerr << "Chunk resolution " << config.terrain.chunkResolution
+                  << " is not 2^n + 1, LOD edges will not line up" << std::endl;
+    }
+    for (std::size_t i = 1; i < config.terrain.lodDistances.size(); ++i) {
+        if (config.terrain.lodDistances[i] - config.terrain.lodDistances[i - 1] < config.terrain.chunkSize) {
+            std::cerr << "LOD band " << i << " is narrower than a chunk, neighbours may skip a level and crack" << std::endl;
+        }
+    }
     
-    // Pre-allocate chunk pool
-    for (int i = 0; i < config.terrain.maxChunkPoolSize; ++i) {
-        chunkPool.push(std::make_unique<TerrainChunk>(glm::ivec2(0, 0), config.terrain.chunkResolution, config.terrain.chunkSize));
+    // A few builds per worker keep them busy between updates
+    if (config.performance.multiThreadedChunkGeneration) {
+        int threads = config.performance.chunkGenerationThreads;
+        if (threads <= 0) {
+            threads = std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1);
+        }
+        buildPool = std::make_unique<WorkerPool<ChunkBuild>>(threads);
+        maxRunningBuilds = 4 * static_cast<std::size_t>(buildPool->getThreadCount());
     }
 }
 
 void DynamicTerrain::update(const glm::vec3& playerPos, const glm::mat4& viewProjection) {
     updateChunks(playerPos, viewProjection);
+    
+    // The copies of this update are fenced before the ring comes round again
+    if (uploadRing) {
+        uploadRing->endFrame();
+    }
 }
 
 void DynamicTerrain::updateChunks(const glm::vec3& playerPos, const glm::mat4& viewProjection) {
@@ -31,37 +129,37 @@ void DynamicTerrain::updateChunks(const glm::vec3& playerPos, const glm::mat4& v
     // Force update on first frame
     bool forceUpdate = (lastPlayerChunk.x == INT_MAX);
     
-    // Only update if player moved to new chunk
-    if (!forceUpdate && playerChunk == lastPlayerChunk) {
-        return;
-    }
-    lastPlayerChunk = playerChunk;
-    
-    // Mark chunks for removal if too far
-    std::vector<glm::ivec2> toRemove;
-    for (auto& [coord, chunk] : chunks) {
-        if (std::abs(coord.x - playerChunk.x) > config.terrain.viewDistance ||
-            std::abs(coord.y - playerChunk.y) > config.terrain.viewDistance) {
-            toRemove.push_back(coord);
-        }
-    }
-    
-    // Remove and recycle distant chunks
-    for (const auto& coord : toRemove) {
-        auto it = chunks.find(coord);
-        if (it != chunks.end()) {
-            chunkPool.push(std::move(it->second));
-            chunks.erase(it);
-        }
+    // Builds finished since the last update join the tree first
+    lodCenter = playerPos;
+    if (buildPool) {
+        collectBuilds(playerPos, false);
     }
     
-    // Generate new chunks around player
-    for (int z = -config.terrain.viewDistance; z <= config.terrain.viewDistance; ++z) {
-        for (int x = -config.terrain.viewDistance; x <= config.terrain.viewDistance; ++x) {
-            glm::ivec2 coord = playerChunk + glm::ivec2(x, z);
-            
-            if (chunks.find(coord) == chunks.end()) {
-                auto chunk = getOrCreateChunk(coord);
+    // Morphing vertices follow the camera continuously, so chunk LODs have
+    // to as well; otherwise only update if player moved to new chunk
+    if (forceUpdate || playerChunk != lastPlayerChunk) {
+        lastPlayerChunk = playerChunk;
+        
+        // Remove distant chunks, freeing their GPU ranges; the quadtree only
+        // visits the subtrees that cross the edge of the view
+        const glm::ivec2 windowMin = playerChunk - glm::ivec2(config.terrain.viewDistance);
+        const glm::ivec2 windowMax = playerChunk + glm::ivec2(config.terrain.viewDistance);
+        chunks.removeOutside(windowMin, windowMax, [this](glm::ivec2 coord, std::unique_ptr<TerrainChunk>&&) {
+            dirtyChunks.push_back(coord);
+        });
+        
+        // Generate new chunks around player, skipping full subtrees
+        std::vector<glm::ivec2> missing;
+        chunks.forEachMissing(windowMin, windowMax, [&missing](glm::ivec2 coord) { missing.push_back(coord); });
+        if (buildPool) {
+            for (const glm::ivec2& coord : missing) {
+                requestBuild(coord);
+            }
+        } else {
+            // One scratch serves every chunk built this update
+            std::unique_ptr<MeshScratch> scratch = scratchPool.acquire();
+            for (const glm::ivec2& coord : missing) {
+                auto chunk = createChunk(coord);
                 
                 // Calculate LOD based on distance
                 float distance = chunk->getDistanceFrom(playerPos);
@@ -69,72 +167,282 @@ void DynamicTerrain::updateChunks(const glm::vec3& playerPos, const glm::mat4& v
                 chunk->setLOD(lod);
                 
                 // Generate terrain with biome support (initial generation)
-                chunk->generate(*heightNoise);
-                chunks[coord] = std::move(chunk);
+                chunk->generate(*biomeGen, *heightNoise, *indexCache, *scratch);
+                chunks.insert(coord, std::move(chunk));
+                dirtyChunks.push_back(coord);
             }
+            scratchPool.release(std::move(scratch));
         }
+        
+        // Update LOD levels for existing chunks
+        updateLods(playerPos);
+    } else if (lodMode == LodMode::MORPH) {
+        updateLods(playerPos);
     }
     
+    // The first view waits for its whole window, built in parallel, rather
+    // than filling in over the first frames
+    if (buildPool) {
+        submitBuilds(playerPos);
+        if (forceUpdate) {
+            collectBuilds(playerPos, true);
+        }
+    }
+    stitchChunks();
+}
+
+void DynamicTerrain::updateLods(const glm::vec3& playerPos) {
+    // Chunk centers in a quadtree node span a rectangle, and no center is
+    // nearer the player than its nearest point or further than its furthest
+    // corner. When both select the same LOD, so does every chunk under the
+    // node. The centers are computed as TerrainChunk::getDistanceFrom does.
+    const float chunkSize = static_cast<float>(Config::getInstance().terrain.chunkSize);
+    auto bandOf = [&](glm::ivec2 low, glm::ivec2 high) {
+        glm::vec2 centerMin(low.x * chunkSize + chunkSize * 0.5f, low.y * chunkSize + chunkSize * 0.5f);
+        glm::vec2 centerMax(high.x * chunkSize + chunkSize * 0.5f, high.y * chunkSize + chunkSize * 0.5f);
+        glm::vec3 nearest(std::clamp(playerPos.x, centerMin.x, centerMax.x), 0.0f, std::clamp(playerPos.z, centerMin.y, centerMax.y));
+        glm::vec3 furthest(std::abs(playerPos.x - centerMin.x) > std::abs(playerPos.x - centerMax.x) ? centerMin.x : centerMax.x, 0.0f,
+                           std::abs(playerPos.z - centerMin.y) > std::abs(playerPos.z - centerMax.y) ? centerMin.y : centerMax.y);
+        int lod = calculateLOD(glm::length(playerPos - nearest));
+        return lod == calculateLOD(glm::length(playerPos - furthest)) ? lod : -1;
+    };
     
-    // Update LOD levels for existing chunks
-    for (auto& [coord, chunk] : chunks) {
+    // Regenerate chunks whose LOD changed; scratch is only taken if one did
+    std::unique_ptr<MeshScratch> scratch;
+    lodNodes = chunks.updateLods(bandOf, [&](glm::ivec2 coord, std::unique_ptr<TerrainChunk>& chunk) {
         float distance = chunk->getDistanceFrom(playerPos);
         int newLod = calculateLOD(distance);
-        if (chunk->getLOD() != newLod) {
+        if (chunk->getLOD() != newLod && buildPool) {
+            requestBuild(coord); // Its replacement is built off the main thread
+        } else if (chunk->getLOD() != newLod) {
+            if (!scratch) {
+                scratch = scratchPool.acquire();
+            }
             chunk->setLOD(newLod);
-            chunk->generate(*heightNoise); // Regenerate if LOD changed
+            chunk->generate(*biomeGen, *heightNoise, *indexCache, *scratch); // Regenerate if LOD changed
+            dirtyChunks.push_back(coord);
         }
-    }
+    });
     
-    // Note: Stitching system temporarily disabled for debugging
-    // The edge alignment fix should reduce gaps significantly
+    if (scratch) {
+        scratchPool.release(std::move(scratch));
+    }
 }
 
-int DynamicTerrain::calculateLOD(float distance) const {
-    Config& config = Config::getInstance();
-    for (int i = 0; i < config.terrain.lodDistances.size(); ++i) {
-        if (distance < config.terrain.lodDistances[i]) {
-            return i;
+void DynamicTerrain::stitchChunks() {
+    // Edges facing a coarser neighbour switch to a stitched index variant;
+    // this only rebinds indices, the vertices are left alone. Only chunks
+    // next to one that came, went or changed LOD can need a new variant.
+    const glm::ivec2 around[] = {glm::ivec2(0, 0), glm::ivec2(0, -1), glm::ivec2(0, 1), glm::ivec2(1, 0), glm::ivec2(-1, 0)};
+    for (const glm::ivec2& dirty : dirtyChunks) {
+        for (const glm::ivec2& offset : around) {
+            glm::ivec2 coord = dirty + offset;
+            std::unique_ptr<TerrainChunk>* chunk = chunks.find(coord);
+            if (chunk != nullptr) {
+                (*chunk)->stitchToNeighbors(*indexCache,
+                                            getNeighborLOD(coord + glm::ivec2(0, -1)), getNeighborLOD(coord + glm::ivec2(0, 1)),
+                                            getNeighborLOD(coord + glm::ivec2(1, 0)), getNeighborLOD(coord + glm::ivec2(-1, 0)));
+            }
         }
     }
-    return config.terrain.maxLodLevels - 1;
+    dirtyChunks.clear();
+}
+
+int DynamicTerrain::calculateLOD(float distance) const {
+    Config& config = Config::getInstance();
+    return selectLod(config.terrain.lodDistances, config.terrain.maxLodLevels, distance);
 }
 
 int DynamicTerrain::getNeighborLOD(const glm::ivec2& coord) const {
-    auto it = chunks.find(coord);
-    if (it != chunks.end()) {
-        return it->second->getLOD();
+    const std::unique_ptr<TerrainChunk>* chunk = chunks.find(coord);
+    if (chunk != nullptr) {
+        return (*chunk)->getLOD();
     }
     return -1; // No neighbor found
 }
 
-std::unique_ptr<TerrainChunk> DynamicTerrain::getOrCreateChunk(const glm::ivec2& coord) {
+std::unique_ptr<TerrainChunk> DynamicTerrain::createChunk(const glm::ivec2& coord) {
     Config& config = Config::getInstance();
-    if (!chunkPool.empty()) {
-        auto chunk = std::move(chunkPool.front());
-        chunkPool.pop();
-        // Reinitialize with new coordinates
-        chunk = std::make_unique<TerrainChunk>(coord, config.terrain.chunkResolution, config.terrain.chunkSize);
-        return chunk;
-    }
-    return std::make_unique<TerrainChunk>(coord, config.terrain.chunkResolution, config.terrain.chunkSize);
+    return std::make_unique<TerrainChunk>(coord, config.terrain.chunkResolution, config.terrain.chunkSize, 0, meshOptions);
 }
 
-void DynamicTerrain::render(Shader& shader, Shader& shadowShader, const glm::mat4& lightSpaceMatrix, const glm::mat4& viewProjection) {
+void DynamicTerrain::render(Shader& shader, Shader& shadowShader, const glm::mat4& lightSpaceMatrix, const glm::mat4& viewProjection,
+                            std::optional<glm::vec3> occlusionEye) {
     glm::mat4 model = glm::mat4(1.0f);
     shader.setMat4("model", model);
     
-    // Render chunks with frustum culling for infinite terrain
+    // Whole quadtree subtrees in or out of this pass's frustum at once
+    cullTests = chunks.cull(Frustum::fromMatrix(viewProjection), visibleChunks);
+    culledChunks = static_cast<int>(chunks.size() - visibleChunks.size());
+    
+    // Then what is left, front to back against the horizon of nearer chunks
+    occludedChunks = 0;
+    if (horizonCulling && occlusionEye) {
+        occludedChunks = static_cast<int>(
+            horizonCuller.cull(*occlusionEye, static_cast<float>(Config::getInstance().terrain.chunkSize), visibleChunks));
+    }
     int renderedChunks = 0;
-    int totalChunks = chunks.size();
     
-    for (auto& [coord, chunk] : chunks) {
-        // Use frustum culling to only render visible chunks
-        if (chunk->isVisible(viewProjection)) {
-            chunk->render();
+    // Row strips are separated by the restart index
+    if (indexCache->usesPrimitiveRestart()) {
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(indexCache->getRestartIndex());
+    }
+    
+    // Morphing reads the arena's buffer texture from this unit
+    shader.setVec3("lodCenter", lodCenter);
+    shader.setInt("chunkVertices", MORPH_TEXTURE_UNIT);
+    shader.setInt("heightTileArray", HEIGHT_TILE_TEXTURE_UNIT);
+    
+    // Height tiles: a handful of instanced draws for the whole terrain
+    if (heightTiles) {
+        tileInstances.clear();
+        for (const TerrainChunk* chunk : visibleChunks) {
+            tileInstances.push_back(chunk->getTileInstance());
+            renderedChunks++;
+        }
+        drawCalls = heightTiles->render(shader, tileInstances, *indexCache,
+                                        lodMode == LodMode::MORPH ? morphRanges : std::vector<LodMorphRange>{},
+                                        HEIGHT_TILE_TEXTURE_UNIT);
+        drawnChunks = renderedChunks;
+        if (indexCache->usesPrimitiveRestart()) {
+            glDisable(GL_PRIMITIVE_RESTART);
+        }
+        return;
+    }
+    
+    // Everything else is one multi-draw out of the arena
+    chunkDraws.clear();
+    for (const TerrainChunk* chunk : visibleChunks) {
+        if (chunk->getIndexCount() > 0) {
+            chunkDraws.push_back(chunk->getDraw(lodMode == LodMode::MORPH ? morphRanges[chunk->getLOD()] : LodMorphRange{}));
             renderedChunks++;
         }
     }
+    shader.setBool("compactVertices", meshOptions.vertexFormat == VertexFormat::COMPACT);
+    shader.setFloat("chunkSize", static_cast<float>(Config::getInstance().terrain.chunkSize));
+    glActiveTexture(GL_TEXTURE0 + MORPH_TEXTURE_UNIT);
+    drawCalls = arena->draw(chunkDraws);
+    drawnChunks = renderedChunks;
+    
+    glActiveTexture(GL_TEXTURE0);
+    if (indexCache->usesPrimitiveRestart()) {
+        glDisable(GL_PRIMITIVE_RESTART);
+    }
+}
+
+bool DynamicTerrain::inWindow(const glm::ivec2& coord) const {
+    const int viewDistance = Config::getInstance().terrain.viewDistance;
+    return std::abs(coord.x - lastPlayerChunk.x) <= viewDistance && std::abs(coord.y - lastPlayerChunk.y) <= viewDistance;
+}
+
+void DynamicTerrain::requestBuild(const glm::ivec2& coord) {
+    // One that is running already gets checked for a stale LOD as it lands
+    if (runningBuilds.count(coord) == 0 && queuedBuilds.insert(coord).second) {
+        buildQueue.push_back(coord);
+        buildQueueSorted = false;
+    }
+}
+
+void DynamicTerrain::submitBuilds(const glm::vec3& playerPos) {
+    // Nearest first, and only a few per worker at a time, so the order
+    // follows the camera and few scratches are held
+    const float chunkSize = static_cast<float>(Config::getInstance().terrain.chunkSize);
+    auto distanceTo = [&](const glm::ivec2& coord) {
+        glm::vec2 center((coord.x + 0.5f) * chunkSize, (coord.y + 0.5f) * chunkSize);
+        return glm::length(center - glm::vec2(playerPos.x, playerPos.z));
+    };
+    if (!buildQueueSorted) {
+        std::sort(buildQueue.begin(), buildQueue.end(),
+                  [&](const glm::ivec2& a, const glm::ivec2& b) { return distanceTo(a) > distanceTo(b); });
+        buildQueueSorted = true;
+    }
+    
+    while (runningBuilds.size() < maxRunningBuilds && !buildQueue.empty()) {
+        glm::ivec2 coord = buildQueue.back();
+        buildQueue.pop_back();
+        queuedBuilds.erase(coord);
+        if (!inWindow(coord)) {
+            continue;
+        }
+        
+        // The LOD is chosen now; a chunk already there at that LOD is current
+        auto chunk = createChunk(coord);
+        chunk->setLOD(calculateLOD(chunk->getDistanceFrom(playerPos)));
+        const std::unique_ptr<TerrainChunk>* existing = chunks.find(coord);
+        if (existing != nullptr && (*existing)->getLOD() == chunk->getLOD()) {
+            continue;
+        }
+        
+        runningBuilds.insert(coord);
+        // A failure comes back with its coord rather than through the pool,
+        // so the coord can be built again
+        buildPool->submit([this, coord, chunk = std::move(chunk)]() mutable {
+            ChunkBuild build{coord, std::move(chunk), nullptr, nullptr};
+            try {
+                build.scratch = scratchPool.acquire();
+                build.chunk->build(*biomeGen, *heightNoise, *indexCache, *build.scratch);
+            } catch (...) {
+                build.failure = std::current_exception();
+            }
+            return build;
+        });
+    }
+}
+
+void DynamicTerrain::collectBuilds(const glm::vec3& playerPos, bool wait) {
+    std::exception_ptr failure;
+    do {
+        // Everything collected lands before any failure is rethrown, so no
+        // coord is left running
+        finishedBuilds.clear();
+        try {
+            buildPool->collect(finishedBuilds, wait);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+        for (ChunkBuild& build : finishedBuilds) {
+            runningBuilds.erase(build.coord);
+            if (build.failure) {
+                if (build.scratch) {
+                    scratchPool.release(std::move(build.scratch));
+                }
+                failure = failure ? failure : build.failure;
+                requestBuild(build.coord);
+                continue;
+            }
+            if (!inWindow(build.coord)) {
+                scratchPool.release(std::move(build.scratch));
+                continue;
+            }
+            
+            // Landed at a LOD the camera has since moved out of: go again
+            build.chunk->upload(*indexCache, *build.scratch);
+            scratchPool.release(std::move(build.scratch));
+            if (build.chunk->getLOD() != calculateLOD(build.chunk->getDistanceFrom(playerPos))) {
+                requestBuild(build.coord);
+            }
+            
+            // A chunk that changed LOD drew its old mesh until now; replacing
+            // it frees that mesh's ranges
+            std::unique_ptr<TerrainChunk>* slot = chunks.find(build.coord);
+            if (slot != nullptr) {
+                *slot = std::move(build.chunk);
+                chunks.refit(build.coord);
+            } else {
+                chunks.insert(build.coord, std::move(build.chunk));
+            }
+            dirtyChunks.push_back(build.coord);
+            landedBuilds++;
+        }
+        if (wait && !failure) {
+            submitBuilds(playerPos);
+        }
+    } while (wait && !failure && !runningBuilds.empty());
+    finishedBuilds.clear();
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
 }
 
 float DynamicTerrain::getHeightAt(float x, float z) const {
@@ -143,4 +451,79 @@ float DynamicTerrain::getHeightAt(float x, float z) const {
 
 glm::vec3 DynamicTerrain::getColorAt(float x, float z, float height) const {
     return biomeGen->getColor(x, z, height, *heightNoise);
+}
+
+TerrainMemoryStats DynamicTerrain::getMemoryStats() const {
+    TerrainMemoryStats stats;
+    stats.vertexFormat = meshOptions.vertexFormat;
+    chunks.forEach([&stats](glm::ivec2, const std::unique_ptr<TerrainChunk>& chunk) {
+        stats.chunks++;
+        stats.vertices += chunk->getVertexCount();
+        stats.vertexBytes += chunk->getVertexBytes();
+        stats.retainedBytes += chunk->getRetainedBytes();
+        stats.adaptiveBytes += chunk->getAdaptiveBytes();
+        stats.triangles += chunk->getTriangleCount();
+        stats.gridTriangles += chunk->getGridTriangleCount();
+        stats.maxMeshError = std::max(stats.maxMeshError, chunk->getMeshError());
+    });
+    stats.scratchBytes = scratchPool.getBytes();
+    stats.fullVertexBytes = stats.vertices * sizeof(TerrainVertex);
+    stats.indexBytes = indexCache->getBytes();
+    stats.tileArrayBytes = heightTiles ? heightTiles->getBytes() : 0;
+    stats.uploadRingBytes = uploadRing ? uploadRing->getCapacity() : 0;
+    stats.arenaBytes = arena ? arena->getBytes() : 0;
+    stats.arenaUsedBytes = arena ? arena->getUsedBytes() : 0;
+    return stats;
+}
+
+void DynamicTerrain::printMemoryReport() const {
+    TerrainMemoryStats stats = getMemoryStats();
+    const double mb = 1024.0 * 1024.0;
+    std::cout << "Terrain memory: " << stats.chunks << " chunks, " << stats.vertices << " vertices ("
+              << vertexFormatName(stats.vertexFormat) << ", " << vertexSize(stats.vertexFormat) << " bytes each)" << std::endl;
+    std::cout << "  index encoding " << indexEncodingName(indexCache->getEncoding())
+              << (indexCache->getIndexType() == GL_UNSIGNED_SHORT ? " (16-bit)" : " (32-bit)") << std::endl;
+    std::cout << "  VRAM: vertices " << stats.vertexBytes / mb << " MB (full format " << stats.fullVertexBytes / mb
+              << " MB), shared indices " << stats.indexBytes / mb << " MB" << std::endl;
+    if (meshOptions.meshMode == MeshMode::ADAPTIVE) {
+        std::cout << "  adaptive meshes: " << stats.triangles << " triangles (uniform grid " << stats.gridTriangles << ", "
+                  << static_cast<double>(stats.gridTriangles) / std::max<std::size_t>(stats.triangles, 1) << "x fewer), max error "
+                  << stats.maxMeshError << " (limit " << meshOptions.adaptiveMaxError << "), error maps "
+                  << stats.adaptiveBytes / mb << " MB RAM" << std::endl;
+    }
+    if (arena) {
+        std::cout << "  VRAM: chunk arena " << stats.arenaBytes / mb << " MB, " << stats.arenaUsedBytes / mb << " MB used, "
+                  << arena->getFreeRangeCount() << " free ranges, " << arena->getRelocationCount() << " relocations" << std::endl;
+        std::cout << "  draws: " << drawnChunks << " chunks in " << drawCalls << " call(s) per pass with "
+                  << (arena->usesMultiDrawIndirect() ? "glMultiDrawElementsIndirect" : "glMultiDrawElementsBaseVertex")
+                  << ", per-chunk submission was " << drawnChunks << " draws and " << 2 * drawnChunks << " VAO binds" << std::endl;
+    } else {
+        std::cout << "  draws: " << drawnChunks << " chunks in " << drawCalls << " instanced call(s) per pass" << std::endl;
+    }
+    if (chunks.size() > 0) {
+        std::cout << "  culling: " << culledChunks << " of " << chunks.size() << " chunks ("
+                  << 100 * culledChunks / static_cast<int>(chunks.size()) << "%) outside the last pass's frustum after "
+                  << cullTests << " box tests; " << lodNodes << " quadtree nodes visited for LOD selection" << std::endl;
+        if (horizonCulling) {
+            std::cout << "  horizon culling: " << occludedChunks << " of the " << chunks.size() - culledChunks
+                      << " chunks in the frustum hidden behind nearer terrain" << std::endl;
+        }
+    }
+    if (buildPool) {
+        std::cout << "  generation: " << buildPool->getThreadCount() << " worker threads, " << landedBuilds << " chunks built, "
+                  << buildQueue.size() << " queued, " << runningBuilds.size() << " running" << std::endl;
+    } else {
+        std::cout << "  generation: on the main thread" << std::endl;
+    }
+    if (uploadRing) {
+        std::cout << "  upload ring: " << stats.uploadRingBytes / mb << " MB "
+                  << (uploadRing->isPersistent() ? "persistent-mapped" : "glBufferSubData fallback") << ", "
+                  << uploadRing->getStreamedBytes() / mb << " MB streamed, " << uploadRing->getStallCount()
+                  << " fence waits" << std::endl;
+    }
+    if (heightTiles) {
+        std::cout << "  VRAM: height tile arrays " << stats.tileArrayBytes / mb << " MB allocated" << std::endl;
+    }
+    std::cout << "  RAM: generation scratch " << stats.scratchBytes / mb << " MB (" << scratchPool.getCreatedCount()
+              << " buffers), retained debug copies " << stats.retainedBytes / mb << " MB" << std::endl;
 }
\ No newline at end of file
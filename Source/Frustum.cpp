@@ -0,0 +1,123 @@
+#include "Frustum.h"
+#include <bit>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FRUSTUM_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+Frustum Frustum::fromMatrix(const glm::mat4& viewProjection) {
+    // Gribb-Hartmann: each plane is the w row plus or minus another row of
+    // the matrix. glm is column-major, so row i is m[0..3][i].
+    auto row = [&viewProjection](int i) {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+    Frustum frustum;
+    frustum.planes = {row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(3) + row(2), row(3) - row(2)};
+    for (glm::vec4& plane : frustum.planes) {
+        float length = glm::length(glm::vec3(plane));
+        if (length > 0.0f) {
+            plane /= length;
+        }
+    }
+    return frustum;
+}
+
+bool Frustum::intersects(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+    // Only the corner furthest along the normal matters; if even that is
+    // behind the plane, the whole box is
+    for (const glm::vec4& plane : planes) {
+        float x = plane.x >= 0.0f ? boundsMax.x : boundsMin.x;
+        float y = plane.y >= 0.0f ? boundsMax.y : boundsMin.y;
+        float z = plane.z >= 0.0f ? boundsMax.z : boundsMin.z;
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::contains(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+    // The nearest corner this time
+    for (const glm::vec4& plane : planes) {
+        float x = plane.x >= 0.0f ? boundsMin.x : boundsMax.x;
+        float y = plane.y >= 0.0f ? boundsMin.y : boundsMax.y;
+        float z = plane.z >= 0.0f ? boundsMin.z : boundsMax.z;
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PackedBounds::clear() {
+    for (std::vector<float>* axis : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+        axis->clear();
+    }
+}
+
+void PackedBounds::reserve(std::size_t count) {
+    for (std::vector<float>* axis : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+        axis->reserve(count);
+    }
+}
+
+std::size_t PackedBounds::add(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    minX.push_back(boundsMin.x);
+    minY.push_back(boundsMin.y);
+    minZ.push_back(boundsMin.z);
+    maxX.push_back(boundsMax.x);
+    maxY.push_back(boundsMax.y);
+    maxZ.push_back(boundsMax.z);
+    return minX.size() - 1;
+}
+
+void PackedBounds::cull(const Frustum& frustum, std::vector<std::uint32_t>& visible) const {
+    visible.clear();
+    const std::size_t count = size();
+    
+    // Whether a plane tests the min or max of an axis depends only on the
+    // plane, so the furthest corner is a choice of arrays, not of lanes
+    std::array<const float*, 18> corners;
+    for (std::size_t p = 0; p < frustum.planes.size(); ++p) {
+        const glm::vec4& plane = frustum.planes[p];
+        corners[3 * p] = plane.x >= 0.0f ? maxX.data() : minX.data();
+        corners[3 * p + 1] = plane.y >= 0.0f ? maxY.data() : minY.data();
+        corners[3 * p + 2] = plane.z >= 0.0f ? maxZ.data() : minZ.data();
+    }
+    
+    // Both paths add the same products in the same order as intersects()
+    std::size_t i = 0;
+#ifdef FRUSTUM_X86_SIMD
+    __m128 planes[24];
+    for (std::size_t p = 0; p < frustum.planes.size(); ++p) {
+        for (int c = 0; c < 4; ++c) {
+            planes[4 * p + c] = _mm_set1_ps(frustum.planes[p][c]);
+        }
+    }
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= count; i += 4) {
+        __m128 outside = zero;
+        for (std::size_t p = 0; p < frustum.planes.size(); ++p) {
+            __m128 distance = _mm_mul_ps(planes[4 * p], _mm_loadu_ps(corners[3 * p] + i));
+            distance = _mm_add_ps(distance, _mm_mul_ps(planes[4 * p + 1], _mm_loadu_ps(corners[3 * p + 1] + i)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(planes[4 * p + 2], _mm_loadu_ps(corners[3 * p + 2] + i)));
+            distance = _mm_add_ps(distance, planes[4 * p + 3]);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero));
+        }
+        for (unsigned int inside = ~_mm_movemask_ps(outside) & 0xf; inside != 0; inside &= inside - 1) {
+            visible.push_back(static_cast<std::uint32_t>(i + std::countr_zero(inside)));
+        }
+    }
+#endif
+    for (; i < count; ++i) {
+        bool inside = true;
+        for (std::size_t p = 0; p < frustum.planes.size() && inside; ++p) {
+            const glm::vec4& plane = frustum.planes[p];
+            inside = !(plane.x * corners[3 * p][i] + plane.y * corners[3 * p + 1][i] + plane.z * corners[3 * p + 2][i] + plane.w < 0.0f);
+        }
+        if (inside) {
+            visible.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+}
\ No newline at end of file
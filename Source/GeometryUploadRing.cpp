@@ -0,0 +1,124 @@
+#include "GeometryUploadRing.h"
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Allocations start on cache-line boundaries so generation never shares a
+// write-combining line with the previous chunk's copy
+constexpr std::size_t ALLOCATION_ALIGNMENT = 64;
+
+constexpr GLuint64 FENCE_WAIT_NANOSECONDS = 1000000000;
+
+} // namespace
+
+GeometryUploadRing::GeometryUploadRing(std::size_t capacity)
+    : capacity((capacity + ALLOCATION_ALIGNMENT - 1) / ALLOCATION_ALIGNMENT * ALLOCATION_ALIGNMENT), buffer(0),
+      mapped(nullptr), head(0), fencedHead(0), retiredHead(0), stalls(0) {
+    if (GLEW_ARB_buffer_storage) {
+        // Coherent, so writes need no explicit flush before the copy
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glBufferStorage(GL_COPY_READ_BUFFER, this->capacity, nullptr, flags);
+        mapped = static_cast<std::byte*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, this->capacity, flags));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        if (mapped != nullptr) {
+            return;
+        }
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    memory.resize(this->capacity);
+}
+
+GeometryUploadRing::~GeometryUploadRing() {
+    for (const Fence& pending : fences) {
+        glDeleteSync(pending.sync);
+    }
+    if (buffer != 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+GeometryUploadRing::Allocation GeometryUploadRing::allocate(std::size_t size) {
+    const std::size_t alignedSize = (size + ALLOCATION_ALIGNMENT - 1) / ALLOCATION_ALIGNMENT * ALLOCATION_ALIGNMENT;
+    if (alignedSize > capacity) {
+        throw std::runtime_error("Upload of " + std::to_string(size) + " bytes does not fit the " +
+                                 std::to_string(capacity) + " byte geometry ring");
+    }
+    
+    // Allocations never wrap; the tail of the ring is skipped instead
+    std::size_t offset = head % capacity;
+    if (offset + alignedSize > capacity) {
+        head += capacity - offset;
+        offset = 0;
+    }
+    
+    // The fallback copies on the spot, so its memory is free again at once
+    if (isPersistent()) {
+        waitUntilFree(head + alignedSize);
+    }
+    head += alignedSize;
+    
+    std::byte* base = isPersistent() ? mapped : memory.data();
+    return {base + offset, offset, size};
+}
+
+void GeometryUploadRing::copyTo(const Allocation& allocation, GLuint target, std::size_t targetOffset) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, target);
+    if (isPersistent()) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation.offset, targetOffset, allocation.size);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    } else {
+        glBufferSubData(GL_COPY_WRITE_BUFFER, targetOffset, allocation.size, allocation.data);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GeometryUploadRing::endFrame() {
+    if (isPersistent() && head > fencedHead) {
+        fence();
+    }
+}
+
+void GeometryUploadRing::fence() {
+    fences.push_back({glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), head});
+    fencedHead = head;
+}
+
+void GeometryUploadRing::waitUntilFree(std::size_t position) {
+    // Writing up to position overwrites everything before position - capacity
+    if (position <= capacity + retiredHead) {
+        return;
+    }
+    const std::size_t reused = position - capacity;
+    
+    // Bytes of this frame that have not been fenced yet: a chunk burst larger
+    // than the ring has to wait for its own earlier copies
+    if (fencedHead < reused) {
+        fence();
+    }
+    
+    // Fences signal in order, so only the first one reaching reused needs
+    // waiting on; the ones before it are dropped
+    while (fences.front().end < reused) {
+        glDeleteSync(fences.front().sync);
+        fences.pop_front();
+    }
+    GLsync sync = fences.front().sync;
+    GLenum status = glClientWaitSync(sync, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        stalls++;
+        do {
+            status = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_WAIT_NANOSECONDS);
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    retiredHead = fences.front().end;
+    glDeleteSync(sync);
+    fences.pop_front();
+}
\ No newline at end of file
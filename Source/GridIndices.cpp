@@ -0,0 +1,117 @@
+#include "GridIndices.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Index of vertex (x, z) once the stitched edges have dropped their odd vertices
+unsigned int stitchedVertex(int x, int z, int vertexResolution, unsigned int stitchedEdges) {
+    const int last = vertexResolution - 1;
+    if ((x % 2 == 1) && (((stitchedEdges & EDGE_NORTH) && z == 0) || ((stitchedEdges & EDGE_SOUTH) && z == last))) {
+        --x;
+    } else if ((z % 2 == 1) && (((stitchedEdges & EDGE_WEST) && x == 0) || ((stitchedEdges & EDGE_EAST) && x == last))) {
+        --z;
+    }
+    return z * vertexResolution + x;
+}
+
+// Cell diagonals run from top right to bottom left, so with both the south
+// and east edges stitched the corner cell would fold into a sliver along
+// its diagonal. That cell uses the other diagonal instead.
+bool flipsCornerCell(unsigned int stitchedEdges) {
+    return (stitchedEdges & EDGE_SOUTH) && (stitchedEdges & EDGE_EAST);
+}
+
+} // namespace
+
+IndexEncoding parseIndexEncoding(const std::string& name) {
+    if (name == "triangles") return IndexEncoding::TRIANGLES;
+    if (name == "strips") return IndexEncoding::STRIPS;
+    throw std::runtime_error("Unknown index encoding: " + name);
+}
+
+const char* indexEncodingName(IndexEncoding encoding) {
+    return encoding == IndexEncoding::STRIPS ? "strips" : "triangles";
+}
+
+int lodVertexResolution(int resolution, int lod) {
+    return std::max(((resolution - 1) >> lod) + 1, 2); // Minimum 2x2 grid
+}
+
+bool canStitchEdges(int vertexResolution) {
+    return vertexResolution >= 3 && (vertexResolution - 1) % 2 == 0;
+}
+
+std::vector<unsigned int> buildGridTriangles(int vertexResolution, unsigned int stitchedEdges) {
+    if (!canStitchEdges(vertexResolution)) {
+        stitchedEdges = 0;
+    }
+    
+    std::vector<unsigned int> indices;
+    indices.reserve((vertexResolution - 1) * (vertexResolution - 1) * 6);
+    auto addTriangle = [&](unsigned int a, unsigned int b, unsigned int c) {
+        if (a != b && b != c && a != c) {
+            indices.push_back(a);
+            indices.push_back(b);
+            indices.push_back(c);
+        }
+    };
+    
+    for (int z = 0; z < vertexResolution - 1; ++z) {
+        for (int x = 0; x < vertexResolution - 1; ++x) {
+            unsigned int topLeft = stitchedVertex(x, z, vertexResolution, stitchedEdges);
+            unsigned int topRight = stitchedVertex(x + 1, z, vertexResolution, stitchedEdges);
+            unsigned int bottomLeft = stitchedVertex(x, z + 1, vertexResolution, stitchedEdges);
+            unsigned int bottomRight = stitchedVertex(x + 1, z + 1, vertexResolution, stitchedEdges);
+            
+            if (flipsCornerCell(stitchedEdges) && x == vertexResolution - 2 && z == vertexResolution - 2) {
+                addTriangle(topLeft, bottomLeft, bottomRight);
+                addTriangle(topLeft, bottomRight, topRight);
+                continue;
+            }
+            addTriangle(topLeft, bottomLeft, topRight);
+            addTriangle(topRight, bottomLeft, bottomRight);
+        }
+    }
+    return indices;
+}
+
+std::vector<unsigned int> buildGridStrips(int vertexResolution, unsigned int restartIndex, unsigned int stitchedEdges,
+                                          int bandCells) {
+    if (!canStitchEdges(vertexResolution)) {
+        stitchedEdges = 0;
+    }
+    const int cells = vertexResolution - 1;
+    if (bandCells <= 0 || bandCells > cells) {
+        bandCells = cells;
+    }
+    
+    std::vector<unsigned int> indices;
+    const int bands = (cells + bandCells - 1) / bandCells;
+    indices.reserve(bands * cells * (2 * bandCells + 3));
+    for (int left = 0; left < cells; left += bandCells) {
+        const int right = std::min(left + bandCells, cells); // Last vertex column of the band
+        for (int z = 0; z < cells; ++z) {
+            if (!indices.empty()) {
+                indices.push_back(restartIndex);
+            }
+            
+            // The flipped corner cell gets a strip of its own
+            const bool cornerCell = right == cells && z == cells - 1 && flipsCornerCell(stitchedEdges);
+            const int end = cornerCell ? right - 1 : right;
+            for (int x = left; x <= end; ++x) {
+                indices.push_back(stitchedVertex(x, z, vertexResolution, stitchedEdges));
+                indices.push_back(stitchedVertex(x, z + 1, vertexResolution, stitchedEdges));
+            }
+            if (cornerCell) {
+                int x = right - 1;
+                indices.push_back(restartIndex);
+                indices.push_back(stitchedVertex(x, z + 1, vertexResolution, stitchedEdges));
+                indices.push_back(stitchedVertex(x + 1, z + 1, vertexResolution, stitchedEdges));
+                indices.push_back(stitchedVertex(x, z, vertexResolution, stitchedEdges));
+                indices.push_back(stitchedVertex(x + 1, z, vertexResolution, stitchedEdges));
+            }
+        }
+    }
+    return indices;
+}
\ No newline at end of file
@@ -0,0 +1,170 @@
+#include "HeightTileStore.h"
+#include "GridIndices.h"
+#include <algorithm>
+#include <cstddef>
+
+namespace {
+
+// The first array of a LOD holds this many tiles; each further one doubles
+constexpr int FIRST_PAGE_LAYERS = 16;
+constexpr int MAX_PAGE_LAYERS = 2048;
+
+} // namespace
+
+HeightTileStore::HeightTileStore(int resolution, float chunkSize, int lodLevels)
+    : resolution(resolution), chunkSize(chunkSize), pages(std::max(lodLevels, 1)) {
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+    maxLayers = std::min(maxLayers, MAX_PAGE_LAYERS);
+    
+    // No vertex attributes, only the per-instance chunk data
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &instanceBuffer);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glEnableVertexAttribArray(7);
+    glVertexAttribDivisor(7, 1);
+    glEnableVertexAttribArray(8);
+    glVertexAttribDivisor(8, 1);
+    glEnableVertexAttribArray(9);
+    glVertexAttribDivisor(9, 1);
+    glBindVertexArray(0);
+}
+
+HeightTileStore::~HeightTileStore() {
+    for (const std::vector<Page>& lodPages : pages) {
+        for (const Page& page : lodPages) {
+            glDeleteTextures(1, &page.texture);
+        }
+    }
+    glDeleteBuffers(1, &instanceBuffer);
+    glDeleteVertexArrays(1, &VAO);
+}
+
+HeightTileStore::Slot HeightTileStore::allocate(int lod) {
+    lod = std::clamp(lod, 0, static_cast<int>(pages.size()) - 1);
+    std::vector<Page>& lodPages = pages[lod];
+    for (int i = 0; i < static_cast<int>(lodPages.size()); ++i) {
+        if (!lodPages[i].freeLayers.empty()) {
+            Slot slot{lod, i, lodPages[i].freeLayers.back()};
+            lodPages[i].freeLayers.pop_back();
+            return slot;
+        }
+    }
+    
+    Page page;
+    page.layers = std::min(FIRST_PAGE_LAYERS << std::min(static_cast<int>(lodPages.size()), 16), maxLayers);
+    for (int layer = page.layers - 1; layer >= 0; --layer) {
+        page.freeLayers.push_back(layer);
+    }
+    
+    // Integer textures are only complete without filtering or mipmaps
+    int size = lodVertexResolution(resolution, lod);
+    glGenTextures(1, &page.texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, page.texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGB16UI, size, size, page.layers, 0, GL_RGB_INTEGER, GL_UNSIGNED_SHORT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    
+    Slot slot{lod, static_cast<int>(lodPages.size()), page.freeLayers.back()};
+    page.freeLayers.pop_back();
+    lodPages.push_back(std::move(page));
+    return slot;
+}
+
+void HeightTileStore::release(Slot& slot) {
+    if (slot.valid()) {
+        pages[slot.lod][slot.page].freeLayers.push_back(slot.layer);
+    }
+    slot = Slot{};
+}
+
+void HeightTileStore::upload(const Slot& slot, std::span<const HeightTileTexel> texels) {
+    int size = lodVertexResolution(resolution, slot.lod);
+    
+    // Rows of 6-byte texels are only 2-byte aligned
+    glBindTexture(GL_TEXTURE_2D_ARRAY, pages[slot.lod][slot.page].texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, slot.layer, size, size, 1, GL_RGB_INTEGER, GL_UNSIGNED_SHORT, texels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+int HeightTileStore::render(const Shader& shader, std::span<const Instance> instances, const ChunkIndexCache& indexCache,
+                             const std::vector<LodMorphRange>& morphRanges, int textureUnit) {
+    if (instances.empty()) {
+        return 0;
+    }
+    
+    // Chunks that share a LOD, array and index variant become one draw
+    sorted.assign(instances.begin(), instances.end());
+    std::sort(sorted.begin(), sorted.end(), [](const Instance& a, const Instance& b) {
+        if (a.slot.lod != b.slot.lod) return a.slot.lod < b.slot.lod;
+        if (a.slot.page != b.slot.page) return a.slot.page < b.slot.page;
+        return a.stitchedEdges < b.stitchedEdges;
+    });
+    
+    // A grid that cannot be halved has no coarser vertices to slide onto
+    gpuInstances.clear();
+    for (const Instance& instance : sorted) {
+        const int lod = instance.slot.lod;
+        const int size = lodVertexResolution(resolution, lod);
+        LodMorphRange morph;
+        if (lod < static_cast<int>(morphRanges.size()) && canStitchEdges(size)) {
+            morph = morphRanges[lod];
+        }
+        gpuInstances.push_back({instance.originX, instance.originZ, instance.heightQuantization.base,
+                                instance.heightQuantization.step, static_cast<std::uint32_t>(instance.slot.layer),
+                                instance.pinnedEdges, static_cast<std::uint32_t>(size), morph.start, morph.end});
+    }
+    
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, gpuInstances.size() * sizeof(ChunkAttributes), gpuInstances.data(), GL_STREAM_DRAW);
+    
+    shader.setBool("heightTiles", true);
+    shader.setBool("compactVertices", false);
+    shader.setFloat("chunkSize", chunkSize);
+    shader.setInt("heightTileArray", textureUnit);
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    
+    int calls = 0;
+    std::size_t begin = 0;
+    while (begin < sorted.size()) {
+        const Instance& first = sorted[begin];
+        std::size_t end = begin + 1;
+        while (end < sorted.size() && sorted[end].slot.lod == first.slot.lod && sorted[end].slot.page == first.slot.page &&
+               sorted[end].stitchedEdges == first.stitchedEdges) {
+            ++end;
+        }
+        
+        const ChunkIndexCache::IndexBuffer& indices = indexCache.get(first.slot.lod, first.stitchedEdges);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, pages[first.slot.lod][first.slot.page].texture);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indices.buffer);
+        std::size_t base = begin * sizeof(ChunkAttributes);
+        glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(ChunkAttributes), (void*)(base + offsetof(ChunkAttributes, originX)));
+        glVertexAttribIPointer(8, 3, GL_UNSIGNED_INT, sizeof(ChunkAttributes), (void*)(base + offsetof(ChunkAttributes, base)));
+        glVertexAttribPointer(9, 2, GL_FLOAT, GL_FALSE, sizeof(ChunkAttributes), (void*)(base + offsetof(ChunkAttributes, morphStart)));
+        glDrawElementsInstanced(indices.mode, indices.count, indices.type, (void*)indices.offset,
+                                static_cast<GLsizei>(end - begin));
+        calls++;
+        begin = end;
+    }
+    
+    glBindVertexArray(0);
+    glActiveTexture(GL_TEXTURE0);
+    shader.setBool("heightTiles", false);
+    return calls;
+}
+
+std::size_t HeightTileStore::getBytes() const {
+    std::size_t bytes = 0;
+    for (int lod = 0; lod < static_cast<int>(pages.size()); ++lod) {
+        std::size_t size = lodVertexResolution(resolution, lod);
+        for (const Page& page : pages[lod]) {
+            bytes += size * size * page.layers * sizeof(HeightTileTexel);
+        }
+    }
+    return bytes;
+}
\ No newline at end of file
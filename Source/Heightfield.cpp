@@ -0,0 +1,73 @@
+#include "Heightfield.h"
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HEIGHTFIELD_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+NormalSource parseNormalSource(const std::string& name) {
+    if (name == "analytic") return NormalSource::ANALYTIC;
+    if (name == "heightfield") return NormalSource::HEIGHTFIELD;
+    throw std::runtime_error("Unknown normal source: " + name);
+}
+
+const char* normalSourceName(NormalSource source) {
+    return source == NormalSource::HEIGHTFIELD ? "heightfield" : "analytic";
+}
+
+void heightfieldNormals(std::span<const float> heights, std::span<const float> xs, std::span<const float> zs,
+                        std::span<glm::vec3> out) {
+    const std::size_t width = xs.size();
+    const std::size_t height = zs.size();
+    if (width < 3 || height < 3 || heights.size() != width * height || out.size() != (width - 2) * (height - 2)) {
+        throw std::invalid_argument("heightfieldNormals: heights must be xs x zs with an apron, out the interior");
+    }
+    const std::size_t inner = width - 2;
+    
+    // Reciprocal spans of the central differences along x, shared by every row
+    std::vector<float> invDx(inner);
+    for (std::size_t x = 0; x < inner; ++x) {
+        invDx[x] = 1.0f / (xs[x + 2] - xs[x]);
+    }
+    
+    // The SIMD and scalar paths do the same operations in the same order,
+    // and sqrt and divide are correctly rounded in both, so every lane
+    // matches the scalar tail exactly
+    for (std::size_t z = 0; z < height - 2; ++z) {
+        const float* up = heights.data() + z * width;
+        const float* mid = up + width;
+        const float* down = mid + width;
+        const float invDz = 1.0f / (zs[z + 2] - zs[z]);
+        glm::vec3* row = out.data() + z * inner;
+        
+        std::size_t x = 0;
+#ifdef HEIGHTFIELD_X86_SIMD
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 vInvDz = _mm_set1_ps(invDz);
+        const __m128 signBit = _mm_set1_ps(-0.0f);
+        for (; x + 4 <= inner; x += 4) {
+            __m128 gx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(mid + x + 2), _mm_loadu_ps(mid + x)), _mm_loadu_ps(&invDx[x]));
+            __m128 gz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(down + x + 1), _mm_loadu_ps(up + x + 1)), vInvDz);
+            __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(gx, gx), _mm_mul_ps(gz, gz)), one);
+            __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+            
+            alignas(16) float nx[4], ny[4], nz[4];
+            _mm_store_ps(nx, _mm_xor_ps(_mm_mul_ps(gx, inv), signBit));
+            _mm_store_ps(ny, inv);
+            _mm_store_ps(nz, _mm_xor_ps(_mm_mul_ps(gz, inv), signBit));
+            for (int lane = 0; lane < 4; ++lane) {
+                row[x + lane] = glm::vec3(nx[lane], ny[lane], nz[lane]);
+            }
+        }
+#endif
+        for (; x < inner; ++x) {
+            float gx = (mid[x + 2] - mid[x]) * invDx[x];
+            float gz = (down[x + 1] - up[x + 1]) * invDz;
+            float inv = 1.0f / std::sqrt(gx * gx + gz * gz + 1.0f);
+            row[x] = glm::vec3(-(gx * inv), inv, -(gz * inv));
+        }
+    }
+}
\ No newline at end of file
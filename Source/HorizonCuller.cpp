@@ -0,0 +1,129 @@
+#include "HorizonCuller.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+HorizonCuller::HorizonCuller(int bins)
+    : eye(0.0f), horizon(std::max(bins, 1), -std::numeric_limits<float>::infinity()), pending(horizon) {}
+
+void HorizonCuller::begin(const glm::vec3& eye) {
+    this->eye = eye;
+    std::fill(horizon.begin(), horizon.end(), -std::numeric_limits<float>::infinity());
+    std::fill(pending.begin(), pending.end(), -std::numeric_limits<float>::infinity());
+    touched.clear();
+}
+
+namespace {
+
+// Goes once round the diamond |x| + |y| = 1 as the angle of direction goes
+// once round, from 0 to 4; in step with it, but with no trigonometry
+double diamondAngle(glm::vec2 direction) {
+    double x = direction.x;
+    double y = direction.y;
+    if (y >= 0.0) {
+        return x >= 0.0 ? y / (x + y) : 1.0 - x / (y - x);
+    }
+    return x < 0.0 ? 2.0 - y / (-x - y) : 3.0 + x / (x - y);
+}
+
+} // namespace
+
+bool HorizonCuller::project(const glm::vec2& footprintMin, const glm::vec2& footprintMax, Footprint& footprint) const {
+    glm::vec2 lo = footprintMin - glm::vec2(eye.x, eye.z);
+    glm::vec2 hi = footprintMax - glm::vec2(eye.x, eye.z);
+    glm::vec2 closest(std::clamp(0.0f, lo.x, hi.x), std::clamp(0.0f, lo.y, hi.y));
+    footprint.nearest = glm::length(closest);
+    if (footprint.nearest <= 0.0f) {
+        return false;
+    }
+    footprint.furthest = glm::length(glm::vec2(std::max(-lo.x, hi.x), std::max(-lo.y, hi.y)));
+    
+    // The outline seen from the eye runs between two corners, picked by
+    // which side of each axis the eye is on
+    glm::vec2 first, last;
+    if (closest.x == 0.0f) {
+        first = glm::vec2(lo.x, closest.y);
+        last = glm::vec2(hi.x, closest.y);
+    } else if (closest.y == 0.0f) {
+        first = glm::vec2(closest.x, lo.y);
+        last = glm::vec2(closest.x, hi.y);
+    } else if ((lo.x > 0.0f) == (lo.y > 0.0f)) {
+        first = glm::vec2(lo.x, hi.y);
+        last = glm::vec2(hi.x, lo.y);
+    } else {
+        first = lo;
+        last = hi;
+    }
+    
+    // Away from the eye, the footprint spans less than half a turn
+    double start = diamondAngle(first);
+    double span = diamondAngle(last) - start;
+    if (span > 2.0) {
+        span -= 4.0;
+    } else if (span < -2.0) {
+        span += 4.0;
+    }
+    if (span < 0.0) {
+        start += span;
+        span = -span;
+        if (start < 0.0) {
+            start += 4.0;
+        }
+    }
+    
+    // Indices past the last bin wrap around
+    const double binsPerQuarter = horizon.size() / 4.0;
+    footprint.firstBin = start * binsPerQuarter;
+    footprint.lastBin = footprint.firstBin + span * binsPerQuarter;
+    return true;
+}
+
+bool HorizonCuller::hidden(const Footprint& footprint, float maxHeight) const {
+    // Steepest line of sight to the box: over its nearest point if the top
+    // is above the eye, its furthest if below
+    const float height = maxHeight - eye.y;
+    const float slope = height / (height > 0.0f ? footprint.nearest : footprint.furthest);
+    const long bins = static_cast<long>(horizon.size());
+    for (long bin = static_cast<long>(std::floor(footprint.firstBin)); bin <= static_cast<long>(std::floor(footprint.lastBin)); ++bin) {
+        if (!(slope < horizon[bin % bins])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HorizonCuller::raise(const Footprint& footprint, float floorHeight) {
+    // Every line of sight in a covered bin crosses the footprint somewhere
+    // between nearest and furthest; take the distance that holds for all
+    const float height = floorHeight - eye.y;
+    const float slope = height / (height > 0.0f ? footprint.furthest : footprint.nearest);
+    const long bins = static_cast<long>(horizon.size());
+    for (long bin = static_cast<long>(std::ceil(footprint.firstBin)); bin + 1 <= static_cast<long>(std::floor(footprint.lastBin)); ++bin) {
+        const int index = static_cast<int>(bin % bins);
+        if (slope > pending[index]) {
+            if (pending[index] == horizon[index]) {
+                touched.push_back(index);
+            }
+            pending[index] = slope;
+        }
+    }
+}
+
+bool HorizonCuller::isHidden(const glm::vec2& footprintMin, const glm::vec2& footprintMax, float maxHeight) const {
+    Footprint footprint;
+    return project(footprintMin, footprintMax, footprint) && hidden(footprint, maxHeight);
+}
+
+void HorizonCuller::addOccluder(const glm::vec2& footprintMin, const glm::vec2& footprintMax, float floorHeight) {
+    Footprint footprint;
+    if (project(footprintMin, footprintMax, footprint)) {
+        raise(footprint, floorHeight);
+    }
+}
+
+void HorizonCuller::commit() {
+    for (int index : touched) {
+        horizon[index] = pending[index];
+    }
+    touched.clear();
+}
\ No newline at end of file
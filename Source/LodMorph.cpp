@@ -0,0 +1,61 @@
+#include "LodMorph.h"
+#include "GridIndices.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+LodMode parseLodMode(const std::string& name) {
+    if (name == "discrete") return LodMode::DISCRETE;
+    if (name == "morph") return LodMode::MORPH;
+    throw std::runtime_error("Unknown LOD mode: " + name);
+}
+
+const char* lodModeName(LodMode mode) {
+    return mode == LodMode::MORPH ? "morph" : "discrete";
+}
+
+int selectLod(const std::vector<float>& lodDistances, int maxLodLevels, float distance) {
+    for (int i = 0; i < static_cast<int>(lodDistances.size()) && i < maxLodLevels; ++i) {
+        if (distance < lodDistances[i]) {
+            return i;
+        }
+    }
+    return std::max(maxLodLevels - 1, 0);
+}
+
+LodMorphRange lodMorphRange(const std::vector<float>& lodDistances, int maxLodLevels, int lod,
+                            float chunkSize, float morphRegion) {
+    // The coarsest level has nothing to morph to
+    if (lod < 0 || lod + 1 >= maxLodLevels || lod >= static_cast<int>(lodDistances.size())) {
+        return {};
+    }
+    
+    const float halfDiagonal = chunkSize * std::sqrt(0.5f);
+    const float bandStart = lod > 0 ? lodDistances[lod - 1] : 0.0f;
+    const float bandEnd = lodDistances[lod];
+    
+    LodMorphRange range;
+    range.end = bandEnd - halfDiagonal;
+    range.start = std::max(range.end - morphRegion * (bandEnd - bandStart), lod > 0 ? bandStart + halfDiagonal : 0.0f);
+    if (!range.morphs()) {
+        return {};
+    }
+    return range;
+}
+
+std::size_t viewTriangleCount(const std::vector<float>& lodDistances, int maxLodLevels, int resolution,
+                              float chunkSize, int viewDistance, const glm::vec3& position) {
+    const glm::ivec2 centre(static_cast<int>(std::floor(position.x / chunkSize)),
+                            static_cast<int>(std::floor(position.z / chunkSize)));
+    std::size_t triangles = 0;
+    for (int z = -viewDistance; z <= viewDistance; ++z) {
+        for (int x = -viewDistance; x <= viewDistance; ++x) {
+            // Same centre distance as TerrainChunk::getDistanceFrom
+            glm::vec3 chunkCentre((centre.x + x + 0.5f) * chunkSize, 0.0f, (centre.y + z + 0.5f) * chunkSize);
+            int lod = selectLod(lodDistances, maxLodLevels, glm::length(position - chunkCentre));
+            std::size_t cells = lodVertexResolution(resolution, lod) - 1;
+            triangles += 2 * cells * cells;
+        }
+    }
+    return triangles;
+}
\ No newline at end of file
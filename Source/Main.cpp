@@ -7,6 +7,7 @@
 #include <memory>
 #include <chrono>
 #include <algorithm>
+#include <optional>
 #include "Camera.h"
 #include "DynamicTerrain.h"
 #include "Water.h"
@@ -155,6 +156,9 @@ public:
                     if (event.key.keysym.sym == SDLK_ESCAPE) {
                         running = false;
                     }
+                    if (event.key.keysym.sym == SDLK_m && terrain) {
+                        terrain->printMemoryReport();
+                    }
                     break;
                 case SDL_KEYUP:
                     keys[event.key.keysym.scancode] = false;
@@ -265,7 +269,7 @@ public:
             glClear(GL_DEPTH_BUFFER_BIT);
             shadowShader->use();
             shadowShader->setMat4("lightSpaceMatrix", lightSpaceMatrix);
-            terrain->render(*shadowShader, *shadowShader, lightSpaceMatrix);
+            terrain->render(*shadowShader, *shadowShader, lightSpaceMatrix, lightSpaceMatrix);
             glBindFramebuffer(GL_FRAMEBUFFER, 0);
         }
         
@@ -359,7 +363,6 @@ public:
         terrainShader->setMat4("lightSpaceMatrix", lightSpaceMatrix);
         terrainShader->setVec3("lightPos", lightPos);
         terrainShader->setVec3("viewPos", camera->position);
-        terrainShader->setVec3("biomeColor", glm::vec3(0.2f, 0.8f, 0.2f));
         
         // Fog parameters for distance blending to skybox
         terrainShader->setFloat("fogDensity", 0.00008f); // Exponential fog density
@@ -377,7 +380,10 @@ public:
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, shadowMap);
         
-        terrain->render(*terrainShader, *shadowShader, lightSpaceMatrix, projection * view);
+        // The reflection's eye is below the water, looking through terrain
+        // the clip plane removes, so only the other passes cull by horizon
+        terrain->render(*terrainShader, *shadowShader, lightSpaceMatrix, projection * view,
+                        clipPlane ? std::nullopt : std::optional<glm::vec3>(camera->position));
         
         if (clipPlane) {
             glDisable(GL_CLIP_DISTANCE0);
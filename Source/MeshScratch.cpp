@@ -0,0 +1,41 @@
+#include "MeshScratch.h"
+
+std::size_t MeshScratch::capacityBytes() const {
+    return (worldXs.capacity() + worldZs.capacity()) * sizeof(float) +
+           samples.capacity() * sizeof(BiomeSample) +
+           heights.capacity() * sizeof(float) +
+           normals.capacity() * sizeof(glm::vec3) +
+           vertices.capacity() * sizeof(TerrainVertex) +
+           compactVertices.capacity() * sizeof(CompactTerrainVertex) +
+           tileTexels.capacity() * sizeof(HeightTileTexel);
+}
+
+std::unique_ptr<MeshScratch> MeshScratchPool::acquire() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (available.empty()) {
+        created++;
+        return std::make_unique<MeshScratch>();
+    }
+    std::unique_ptr<MeshScratch> scratch = std::move(available.back());
+    available.pop_back();
+    return scratch;
+}
+
+void MeshScratchPool::release(std::unique_ptr<MeshScratch> scratch) {
+    std::lock_guard<std::mutex> lock(mutex);
+    available.push_back(std::move(scratch));
+}
+
+std::size_t MeshScratchPool::getBytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::size_t bytes = 0;
+    for (const auto& scratch : available) {
+        bytes += scratch->capacityBytes();
+    }
+    return bytes;
+}
+
+std::size_t MeshScratchPool::getCreatedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return created;
+}
\ No newline at end of file
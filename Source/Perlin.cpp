@@ -1 +1,441 @@
-#include "Perlin.h"
\ No newline at end of file
+#include "Perlin.h"
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PERLIN_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Lane-wise copies of PerlinNoise::noise2D/octaveNoise2D. Each kernel does
+// the same single-precision operations in the same order as the scalar
+// code, so rounding matches. FMA is deliberately not enabled for the SIMD
+// targets, since contracting a*b+c would change the rounding.
+
+void octaveNoiseScalar(const PerlinNoise& perlin, const float* xs, const float* ys,
+                       int octaves, float persistence, int layer, float* out, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = perlin.octaveNoise2D(xs[i], ys[i], octaves, persistence, layer);
+    }
+}
+
+#ifdef PERLIN_X86_SIMD
+
+__attribute__((target("sse4.2")))
+inline __m128 fadeSSE(__m128 t) {
+    const __m128 six = _mm_set1_ps(6.0f);
+    const __m128 fifteen = _mm_set1_ps(15.0f);
+    const __m128 ten = _mm_set1_ps(10.0f);
+    __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, six), fifteen)), ten);
+    return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+}
+
+__attribute__((target("sse4.2")))
+inline __m128 lerpSSE(__m128 t, __m128 a, __m128 b) {
+    return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+}
+
+__attribute__((target("sse4.2")))
+inline __m128 gradSSE(__m128i hash, __m128 x, __m128 y) {
+    const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    
+    // u = h < 8 ? x : y
+    __m128 uIsY = _mm_castsi128_ps(_mm_cmpgt_epi32(h, _mm_set1_epi32(7)));
+    __m128 u = _mm_blendv_ps(x, y, uIsY);
+    
+    // v = h < 4 ? y : (h == 12 || h == 14) ? x : 0
+    __m128 vIsX = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)),
+                                                _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+    __m128 vIsY = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+    __m128 v = _mm_blendv_ps(_mm_and_ps(x, vIsX), y, vIsY);
+    
+    // Bits 0 and 1 of the hash flip the signs of u and v
+    __m128 negU = _mm_castsi128_ps(_mm_slli_epi32(h, 31));
+    __m128 negV = _mm_castsi128_ps(_mm_slli_epi32(_mm_srli_epi32(h, 1), 31));
+    u = _mm_xor_ps(u, _mm_and_ps(negU, signBit));
+    v = _mm_xor_ps(v, _mm_and_ps(negV, signBit));
+    return _mm_add_ps(u, v);
+}
+
+__attribute__((target("sse4.2")))
+__m128 noiseSSE(const std::uint8_t* p, __m128 x, __m128 y, int layer) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 fx = _mm_floor_ps(x);
+    __m128 fy = _mm_floor_ps(y);
+    
+    alignas(16) int cx[4], cy[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(cx), _mm_cvttps_epi32(fx));
+    _mm_store_si128(reinterpret_cast<__m128i*>(cy), _mm_cvttps_epi32(fy));
+    
+    // No gather on SSE: hash each lane with scalar loads, then go wide again
+    const int Z = layer & 255;
+    alignas(16) int h[4][4];
+    for (int lane = 0; lane < 4; ++lane) {
+        int X = cx[lane] & 255;
+        int Y = cy[lane] & 255;
+        int A = p[X] + Y;
+        int B = p[X + 1] + Y;
+        h[0][lane] = p[p[A] + Z];
+        h[1][lane] = p[p[B] + Z];
+        h[2][lane] = p[p[A + 1] + Z];
+        h[3][lane] = p[p[B + 1] + Z];
+    }
+    __m128i hAA = _mm_load_si128(reinterpret_cast<const __m128i*>(h[0]));
+    __m128i hBA = _mm_load_si128(reinterpret_cast<const __m128i*>(h[1]));
+    __m128i hAB = _mm_load_si128(reinterpret_cast<const __m128i*>(h[2]));
+    __m128i hBB = _mm_load_si128(reinterpret_cast<const __m128i*>(h[3]));
+    
+    x = _mm_sub_ps(x, fx);
+    y = _mm_sub_ps(y, fy);
+    __m128 x1 = _mm_sub_ps(x, one);
+    __m128 y1 = _mm_sub_ps(y, one);
+    
+    __m128 u = fadeSSE(x);
+    __m128 v = fadeSSE(y);
+    
+    return lerpSSE(v, lerpSSE(u, gradSSE(hAA, x, y), gradSSE(hBA, x1, y)),
+                      lerpSSE(u, gradSSE(hAB, x, y1), gradSSE(hBB, x1, y1)));
+}
+
+__attribute__((target("sse4.2")))
+void octaveNoiseSSE42(const PerlinNoise& perlin, const std::uint8_t* p, const float* xs, const float* ys,
+                      int octaves, float persistence, int layer, float* out, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(xs + i);
+        __m128 y = _mm_loadu_ps(ys + i);
+        __m128 total = _mm_setzero_ps();
+        float frequency = 1;
+        float amplitude = 1;
+        float maxValue = 0;
+        
+        for (int o = 0; o < octaves; ++o) {
+            __m128 f = _mm_set1_ps(frequency);
+            __m128 n = noiseSSE(p, _mm_mul_ps(x, f), _mm_mul_ps(y, f), layer * (1 << o));
+            total = _mm_add_ps(total, _mm_mul_ps(n, _mm_set1_ps(amplitude)));
+            maxValue += amplitude;
+            amplitude *= persistence;
+            frequency *= 2;
+        }
+        _mm_storeu_ps(out + i, _mm_div_ps(total, _mm_set1_ps(maxValue)));
+    }
+    octaveNoiseScalar(perlin, xs + i, ys + i, octaves, persistence, layer, out + i, count - i);
+}
+
+__attribute__((target("avx2")))
+inline __m256 fadeAVX2(__m256 t) {
+    const __m256 six = _mm256_set1_ps(6.0f);
+    const __m256 fifteen = _mm256_set1_ps(15.0f);
+    const __m256 ten = _mm256_set1_ps(10.0f);
+    __m256 inner = _mm256_add_ps(_mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, six), fifteen)), ten);
+    return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+}
+
+__attribute__((target("avx2")))
+inline __m256 lerpAVX2(__m256 t, __m256 a, __m256 b) {
+    return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+}
+
+__attribute__((target("avx2")))
+inline __m256 gradAVX2(__m256i hash, __m256 x, __m256 y) {
+    const __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    
+    // u = h < 8 ? x : y
+    __m256 uIsY = _mm256_castsi256_ps(_mm256_cmpgt_epi32(h, _mm256_set1_epi32(7)));
+    __m256 u = _mm256_blendv_ps(x, y, uIsY);
+    
+    // v = h < 4 ? y : (h == 12 || h == 14) ? x : 0
+    __m256 vIsX = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)),
+                                                      _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+    __m256 vIsY = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+    __m256 v = _mm256_blendv_ps(_mm256_and_ps(x, vIsX), y, vIsY);
+    
+    // Bits 0 and 1 of the hash flip the signs of u and v
+    __m256 negU = _mm256_castsi256_ps(_mm256_slli_epi32(h, 31));
+    __m256 negV = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_srli_epi32(h, 1), 31));
+    u = _mm256_xor_ps(u, _mm256_and_ps(negU, signBit));
+    v = _mm256_xor_ps(v, _mm256_and_ps(negV, signBit));
+    return _mm256_add_ps(u, v);
+}
+
+__attribute__((target("avx2")))
+inline __m256i permAVX2(const int* p, __m256i index) {
+    return _mm256_i32gather_epi32(p, index, 4);
+}
+
+__attribute__((target("avx2")))
+__m256 noiseAVX2(const int* p, __m256 x, __m256 y, int layer) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256i mask = _mm256_set1_epi32(255);
+    const __m256i oneI = _mm256_set1_epi32(1);
+    const __m256i Z = _mm256_set1_epi32(layer & 255);
+    __m256 fx = _mm256_floor_ps(x);
+    __m256 fy = _mm256_floor_ps(y);
+    
+    __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(fx), mask);
+    __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(fy), mask);
+    
+    __m256i A = _mm256_add_epi32(permAVX2(p, X), Y);
+    __m256i B = _mm256_add_epi32(permAVX2(p, _mm256_add_epi32(X, oneI)), Y);
+    __m256i hAA = permAVX2(p, _mm256_add_epi32(permAVX2(p, A), Z));
+    __m256i hBA = permAVX2(p, _mm256_add_epi32(permAVX2(p, B), Z));
+    __m256i hAB = permAVX2(p, _mm256_add_epi32(permAVX2(p, _mm256_add_epi32(A, oneI)), Z));
+    __m256i hBB = permAVX2(p, _mm256_add_epi32(permAVX2(p, _mm256_add_epi32(B, oneI)), Z));
+    
+    x = _mm256_sub_ps(x, fx);
+    y = _mm256_sub_ps(y, fy);
+    __m256 x1 = _mm256_sub_ps(x, one);
+    __m256 y1 = _mm256_sub_ps(y, one);
+    
+    __m256 u = fadeAVX2(x);
+    __m256 v = fadeAVX2(y);
+    
+    return lerpAVX2(v, lerpAVX2(u, gradAVX2(hAA, x, y), gradAVX2(hBA, x1, y)),
+                       lerpAVX2(u, gradAVX2(hAB, x, y1), gradAVX2(hBB, x1, y1)));
+}
+
+__attribute__((target("avx2")))
+void octaveNoiseAVX2(const PerlinNoise& perlin, const int* p, const float* xs, const float* ys,
+                     int octaves, float persistence, int layer, float* out, std::size_t count) {
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 x = _mm256_loadu_ps(xs + i);
+        __m256 y = _mm256_loadu_ps(ys + i);
+        __m256 total = _mm256_setzero_ps();
+        float frequency = 1;
+        float amplitude = 1;
+        float maxValue = 0;
+        
+        for (int o = 0; o < octaves; ++o) {
+            __m256 f = _mm256_set1_ps(frequency);
+            __m256 n = noiseAVX2(p, _mm256_mul_ps(x, f), _mm256_mul_ps(y, f), layer * (1 << o));
+            total = _mm256_add_ps(total, _mm256_mul_ps(n, _mm256_set1_ps(amplitude)));
+            maxValue += amplitude;
+            amplitude *= persistence;
+            frequency *= 2;
+        }
+        _mm256_storeu_ps(out + i, _mm256_div_ps(total, _mm256_set1_ps(maxValue)));
+    }
+    octaveNoiseScalar(perlin, xs + i, ys + i, octaves, persistence, layer, out + i, count - i);
+}
+
+#endif // PERLIN_X86_SIMD
+
+} // namespace
+
+void PerlinNoise::octaveNoiseBatch(std::span<const float> xs, std::span<const float> ys,
+                                   int octaves, float persistence, std::span<float> out, int layer) const {
+    octaveNoiseBatch(xs, ys, octaves, persistence, out, layer, bestKernel());
+}
+
+void PerlinNoise::octaveNoiseBatch(std::span<const float> xs, std::span<const float> ys,
+                                   int octaves, float persistence, std::span<float> out, int layer,
+                                   NoiseKernel kernel) const {
+    if (xs.size() != ys.size() || xs.size() != out.size()) {
+        throw std::invalid_argument("octaveNoiseBatch: xs, ys and out must have the same length");
+    }
+    if (octaves <= 0) {
+        std::fill(out.begin(), out.end(), 0.0f);
+        return;
+    }
+    if (!isKernelSupported(kernel)) {
+        kernel = NoiseKernel::Scalar;
+    }
+    
+    switch (kernel) {
+#ifdef PERLIN_X86_SIMD
+        case NoiseKernel::AVX2: {
+            // Gathers load 32-bit lanes, so widen the byte table for the
+            // duration of the batch (2 KB on the stack)
+            alignas(32) int widened[512];
+            std::copy(permutation.begin(), permutation.end(), widened);
+            octaveNoiseAVX2(*this, widened, xs.data(), ys.data(), octaves, persistence, layer, out.data(), out.size());
+            return;
+        }
+        case NoiseKernel::SSE42:
+            octaveNoiseSSE42(*this, permutation.data(), xs.data(), ys.data(), octaves, persistence, layer, out.data(), out.size());
+            return;
+#endif
+        default:
+            octaveNoiseScalar(*this, xs.data(), ys.data(), octaves, persistence, layer, out.data(), out.size());
+            return;
+    }
+}
+
+template <typename Sample>
+void PerlinNoise::evaluateGridImpl(std::span<const float> xs, std::span<const float> ys,
+                                   int octaves, float persistence, std::span<Sample> out, int layer) const {
+    constexpr bool withGradient = std::is_same_v<Sample, NoiseGradient>;
+    const std::size_t width = xs.size();
+    const std::size_t height = ys.size();
+    if (out.size() != width * height) {
+        throw std::invalid_argument("evaluateGrid: out must hold xs.size() * ys.size() samples");
+    }
+    std::fill(out.begin(), out.end(), Sample{});
+    if (octaves <= 0) return;
+    
+    // Lattice cell, offset into the cell and fade weights for one column or
+    // row at the current octave
+    struct AxisSample {
+        int cell;
+        float t;
+        float fade;
+        float fadeDerivative;
+    };
+    std::vector<AxisSample> columns(width);
+    std::vector<AxisSample> rows(height);
+    // Corner hashes (AA, BA, AB, BB) for every column of the current row of cells
+    std::vector<std::array<int, 4>> hashes(width);
+    
+    auto setupAxis = [](std::span<const float> coords, float frequency, std::vector<AxisSample>& axis) {
+        for (std::size_t i = 0; i < coords.size(); ++i) {
+            float c = coords[i] * frequency;
+            float f = std::floor(c);
+            AxisSample& a = axis[i];
+            a.cell = static_cast<int>(f) & 255;
+            a.t = c - f;
+            a.fade = fade(a.t);
+            a.fadeDerivative = withGradient ? PerlinNoise::fadeDerivative(a.t) : 0.0f;
+        }
+    };
+    
+    float frequency = 1;
+    float amplitude = 1;
+    float maxValue = 0;
+    
+    for (int o = 0; o < octaves; ++o) {
+        const int Z = (layer * (1 << o)) & 255;
+        setupAxis(xs, frequency, columns);
+        setupAxis(ys, frequency, rows);
+        
+        int hashedRowCell = -1;
+        for (std::size_t j = 0; j < height; ++j) {
+            const AxisSample& row = rows[j];
+            
+            // Rehash only when the row enters a new cell, and within the row
+            // only when the column does
+            if (row.cell != hashedRowCell) {
+                int hashedColumnCell = -1;
+                std::array<int, 4> h = {};
+                for (std::size_t i = 0; i < width; ++i) {
+                    int X = columns[i].cell;
+                    if (X != hashedColumnCell) {
+                        int A = permutation[X] + row.cell;
+                        int B = permutation[X + 1] + row.cell;
+                        h = {permutation[permutation[A] + Z], permutation[permutation[B] + Z],
+                             permutation[permutation[A + 1] + Z], permutation[permutation[B + 1] + Z]};
+                        hashedColumnCell = X;
+                    }
+                    hashes[i] = h;
+                }
+                hashedRowCell = row.cell;
+            }
+            
+            Sample* outRow = out.data() + j * width;
+            const float y = row.t;
+            for (std::size_t i = 0; i < width; ++i) {
+                const AxisSample& column = columns[i];
+                const float x = column.t;
+                const std::array<int, 4>& h = hashes[i];
+                
+                if constexpr (withGradient) {
+                    NoiseGradient n = blendCellWithGradient(h.data(), x, y, column.fade, row.fade,
+                                                            column.fadeDerivative, row.fadeDerivative);
+                    outRow[i].value += n.value * amplitude;
+                    outRow[i].dx += n.dx * amplitude * frequency;
+                    outRow[i].dy += n.dy * amplitude * frequency;
+                } else {
+                    const float u = column.fade;
+                    const float v = row.fade;
+                    float n = lerp(v, lerp(u, grad2D(h[0], x, y), grad2D(h[1], x - 1, y)),
+                                      lerp(u, grad2D(h[2], x, y - 1), grad2D(h[3], x - 1, y - 1)));
+                    outRow[i] += n * amplitude;
+                }
+            }
+        }
+        
+        maxValue += amplitude;
+        amplitude *= persistence;
+        frequency *= 2;
+    }
+    
+    for (Sample& sample : out) {
+        if constexpr (withGradient) {
+            sample.value /= maxValue;
+            sample.dx /= maxValue;
+            sample.dy /= maxValue;
+        } else {
+            sample /= maxValue;
+        }
+    }
+}
+
+void PerlinNoise::evaluateGrid(std::span<const float> xs, std::span<const float> ys,
+                               int octaves, float persistence, std::span<float> out, int layer) const {
+    evaluateGridImpl(xs, ys, octaves, persistence, out, layer);
+}
+
+void PerlinNoise::evaluateGrid(std::span<const float> xs, std::span<const float> ys,
+                               int octaves, float persistence, std::span<NoiseGradient> out, int layer) const {
+    evaluateGridImpl(xs, ys, octaves, persistence, out, layer);
+}
+
+namespace {
+
+std::vector<float> gridAxis(float origin, float step, int count) {
+    std::vector<float> axis(std::max(count, 0));
+    for (int i = 0; i < count; ++i) {
+        axis[i] = origin + i * step;
+    }
+    return axis;
+}
+
+} // namespace
+
+void PerlinNoise::evaluateGrid(float originX, float originY, float step, int width, int height,
+                               int octaves, float persistence, std::span<float> out, int layer) const {
+    evaluateGridImpl<float>(gridAxis(originX, step, width), gridAxis(originY, step, height),
+                            octaves, persistence, out, layer);
+}
+
+void PerlinNoise::evaluateGrid(float originX, float originY, float step, int width, int height,
+                               int octaves, float persistence, std::span<NoiseGradient> out, int layer) const {
+    evaluateGridImpl<NoiseGradient>(gridAxis(originX, step, width), gridAxis(originY, step, height),
+                                    octaves, persistence, out, layer);
+}
+
+bool PerlinNoise::isKernelSupported(NoiseKernel kernel) {
+    switch (kernel) {
+        case NoiseKernel::Scalar:
+            return true;
+#ifdef PERLIN_X86_SIMD
+        case NoiseKernel::SSE42:
+            return __builtin_cpu_supports("sse4.2");
+        case NoiseKernel::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+NoiseKernel PerlinNoise::bestKernel() {
+    static const NoiseKernel best = isKernelSupported(NoiseKernel::AVX2) ? NoiseKernel::AVX2
+                                  : isKernelSupported(NoiseKernel::SSE42) ? NoiseKernel::SSE42
+                                  : NoiseKernel::Scalar;
+    return best;
+}
+
+const char* PerlinNoise::kernelName(NoiseKernel kernel) {
+    switch (kernel) {
+        case NoiseKernel::SSE42: return "SSE4.2";
+        case NoiseKernel::AVX2: return "AVX2";
+        default: return "scalar";
+    }
+}
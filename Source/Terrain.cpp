@@ -1,4 +1,5 @@
 #include "Terrain.h"
+#include "VertexCache.h"
 #include <iostream>
 
 Terrain::Terrain(int width, int height, float scale) 
@@ -21,22 +22,28 @@ void Terrain::generateTerrain() {
     float halfWidth = width * 0.5f;
     float halfHeight = height * 0.5f;
     
+    // Sample the whole grid plus a one-vertex apron in a single pass; the
+    // apron supplies the x - 1 / x + 1 neighbours for the normals
+    const int gridWidth = width + 3;
+    const int gridHeight = height + 3;
+    std::vector<float> noise(gridWidth * gridHeight);
+    perlin->evaluateGrid(-0.02f, -0.02f, 0.02f, gridWidth, gridHeight, 4, 0.5f, noise);
+    auto sample = [&](int x, int z) { return noise[(z + 1) * gridWidth + (x + 1)]; };
+    
     for (int z = 0; z <= height; ++z) {
         for (int x = 0; x <= width; ++x) {
             float xPos = (x - halfWidth) * scale / width;
             float zPos = (z - halfHeight) * scale / height;
             
-            float noiseValue = perlin->octaveNoise(x * 0.02, z * 0.02, 0, 4, 0.5);
+            float noiseValue = sample(x, z);
             float yPos = noiseValue * 30.0f;
             
             vertices.push_back(xPos);
             vertices.push_back(yPos);
             vertices.push_back(zPos);
             
-            float nx = perlin->octaveNoise((x + 1) * 0.02, z * 0.02, 0, 4, 0.5) - 
-                      perlin->octaveNoise((x - 1) * 0.02, z * 0.02, 0, 4, 0.5);
-            float nz = perlin->octaveNoise(x * 0.02, (z + 1) * 0.02, 0, 4, 0.5) - 
-                      perlin->octaveNoise(x * 0.02, (z - 1) * 0.02, 0, 4, 0.5);
+            float nx = sample(x + 1, z) - sample(x - 1, z);
+            float nz = sample(x, z + 1) - sample(x, z - 1);
             
             glm::vec3 normal = glm::normalize(glm::vec3(-nx * 30.0f, 2.0f, -nz * 30.0f));
             vertices.push_back(normal.x);
@@ -64,6 +71,9 @@ void Terrain::generateTerrain() {
             indices.push_back(bottomRight);
         }
     }
+    
+    // Row order reshades every vertex once rows outgrow the vertex cache
+    indices = optimizeVertexCache(indices, static_cast<std::size_t>(width + 1) * (height + 1));
 }
 
 void Terrain::setupMesh() {
@@ -103,5 +113,5 @@ void Terrain::render(const Shader& shader) {
 float Terrain::getHeight(float x, float z) const {
     float noiseX = (x / scale + 0.5f) * width;
     float noiseZ = (z / scale + 0.5f) * height;
-    return perlin->octaveNoise(noiseX * 0.02, noiseZ * 0.02, 0, 4, 0.5) * 30.0f;
+    return perlin->octaveNoise2D(noiseX * 0.02f, noiseZ * 0.02f, 4, 0.5f) * 30.0f;
 }
\ No newline at end of file
@@ -1,139 +1,338 @@
 #include "TerrainChunk.h"
-#include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 
-TerrainChunk::TerrainChunk(glm::ivec2 coord, int resolution, float size, int lod)
-    : chunkCoord(coord), resolution(resolution), chunkSize(size), lodLevel(lod), needsUpdate(true) {
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &EBO);
+namespace {
+
+// ChunkEdge mask of the sides whose neighbour is finer than lod
+unsigned int finerEdges(int lod, int northLOD, int southLOD, int eastLOD, int westLOD) {
+    unsigned int edges = 0;
+    if (northLOD >= 0 && northLOD < lod) edges |= EDGE_NORTH;
+    if (southLOD >= 0 && southLOD < lod) edges |= EDGE_SOUTH;
+    if (eastLOD >= 0 && eastLOD < lod) edges |= EDGE_EAST;
+    if (westLOD >= 0 && westLOD < lod) edges |= EDGE_WEST;
+    return edges;
+}
+
+} // namespace
+
+TerrainChunk::TerrainChunk(glm::ivec2 coord, int resolution, float size, int lod, ChunkMeshOptions options)
+    : arena(options.arena), vertexRange(ArenaAllocator::NONE), indexRange(ArenaAllocator::NONE), heightTiles(options.heightTiles),
+      uploadRing(options.uploadRing), vertexFormat(options.vertexFormat), normalSource(options.normalSource), vertexCount(0),
+      drawIndices{resolution, 0, 0, 0, GL_TRIANGLES, GL_UNSIGNED_INT}, stitchedEdges(0), pinnedEdges(0),
+      meshMode(options.meshMode), adaptiveMaxError(options.adaptiveMaxError), triangleCount(0), meshError(0.0f), boundsMin(0.0f), boundsMax(0.0f),
+      keepCpuMesh(options.keepCpuMesh), chunkCoord(coord), resolution(resolution),
+      vertexResolution(resolution), chunkSize(size), lodLevel(lod), needsUpdate(true),
+      heightQuantization{0.0f, HeightQuantization::MIN_STEP} {
 }
 
 TerrainChunk::~TerrainChunk() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
+    if (heightTiles != nullptr) {
+        heightTiles->release(tileSlot);
+    }
+    if (arena != nullptr) {
+        arena->releaseVertices(vertexRange);
+        arena->releaseIndices(indexRange);
+    }
 }
 
-void TerrainChunk::generate(const PerlinNoise& perlin) {
-    generateMesh(perlin);
-    uploadMesh();
+void TerrainChunk::generate(const BiomeGenerator& biomes, const PerlinNoise& perlin, const ChunkIndexCache& indexCache, MeshScratch& scratch) {
+    stitchedEdges = 0;
+    pinnedEdges = 0;
+    const ChunkIndexCache::IndexBuffer& indices = indexCache.get(lodLevel);
+    vertexResolution = indices.vertexResolution;
+    generateMesh(biomes, perlin, scratch, true);
+    uploadMesh(scratch, meshMode == MeshMode::ADAPTIVE ? buildAdaptiveIndices() : indices);
     needsUpdate = false;
 }
 
-void TerrainChunk::generateWithNeighbors(const PerlinNoise& perlin, int northLOD, int southLOD, int eastLOD, int westLOD) {
-    generateMeshWithStitching(perlin, northLOD, southLOD, eastLOD, westLOD);
-    uploadMesh();
+void TerrainChunk::generateWithNeighbors(const BiomeGenerator& biomes, const PerlinNoise& perlin, const ChunkIndexCache& indexCache,
+                                         MeshScratch& scratch, int northLOD, int southLOD, int eastLOD, int westLOD) {
+    // Vertices never depend on the neighbours; only the index variant does
+    stitchedEdges = ChunkIndexCache::stitchedEdges(lodLevel, northLOD, southLOD, eastLOD, westLOD);
+    pinnedEdges = finerEdges(lodLevel, northLOD, southLOD, eastLOD, westLOD);
+    const ChunkIndexCache::IndexBuffer& indices = indexCache.get(lodLevel, stitchedEdges);
+    vertexResolution = indices.vertexResolution;
+    generateMesh(biomes, perlin, scratch, true);
+    uploadMesh(scratch, meshMode == MeshMode::ADAPTIVE ? buildAdaptiveIndices() : indices);
     needsUpdate = false;
 }
 
-void TerrainChunk::generateMesh(const PerlinNoise& perlin) {
+void TerrainChunk::build(const BiomeGenerator& biomes, const PerlinNoise& perlin, const ChunkIndexCache& indexCache, MeshScratch& scratch) {
+    stitchedEdges = 0;
+    pinnedEdges = 0;
+    vertexResolution = indexCache.get(lodLevel).vertexResolution;
+    generateMesh(biomes, perlin, scratch, false);
+}
+
+void TerrainChunk::upload(const ChunkIndexCache& indexCache, const MeshScratch& scratch) {
+    uploadMesh(scratch, meshMode == MeshMode::ADAPTIVE ? buildAdaptiveIndices() : indexCache.get(lodLevel));
+    needsUpdate = false;
+}
+
+bool TerrainChunk::stitchToNeighbors(const ChunkIndexCache& indexCache, int northLOD, int southLOD, int eastLOD, int westLOD) {
+    // The finer neighbour stitches to this chunk's unmorphed edge vertices
+    pinnedEdges = finerEdges(lodLevel, northLOD, southLOD, eastLOD, westLOD);
+    
+    unsigned int edges = ChunkIndexCache::stitchedEdges(lodLevel, northLOD, southLOD, eastLOD, westLOD);
+    if (edges == stitchedEdges || needsUpdate) {
+        return false;
+    }
+    stitchedEdges = edges;
+    drawIndices = meshMode == MeshMode::ADAPTIVE ? buildAdaptiveIndices() : indexCache.get(lodLevel, stitchedEdges);
+    return true;
+}
+
+void TerrainChunk::generateMesh(const BiomeGenerator& biomes, const PerlinNoise& perlin, MeshScratch& scratch, bool stage) {
+    std::vector<TerrainVertex>& vertices = scratch.vertices;
+    std::vector<CompactTerrainVertex>& compactVertices = scratch.compactVertices;
+    std::vector<HeightTileTexel>& tileTexels = scratch.tileTexels;
     vertices.clear();
-    indices.clear();
+    compactVertices.clear();
+    tileTexels.clear();
     
-    int vertexResolution = resolution >> lodLevel;
-    if (vertexResolution < 2) vertexResolution = 2; // Minimum 2x2 grid
+    // vertexResolution comes from the index cache entry for this LOD
     float stepSize = chunkSize / (vertexResolution - 1);
     
     glm::vec3 basePos = getWorldPosition();
     
-    for (int z = 0; z < vertexResolution; ++z) {
-        for (int x = 0; x < vertexResolution; ++x) {
-            // Ensure edge vertices are exactly on chunk boundaries
-            float worldX, worldZ;
-            if (x == 0) {
-                worldX = basePos.x; // Exact west edge
-            } else if (x == vertexResolution - 1) {
-                worldX = basePos.x + chunkSize; // Exact east edge
-            } else {
-                worldX = basePos.x + x * stepSize;
-            }
-            
-            if (z == 0) {
-                worldZ = basePos.z; // Exact south edge
-            } else if (z == vertexResolution - 1) {
-                worldZ = basePos.z + chunkSize; // Exact north edge
-            } else {
-                worldZ = basePos.z + z * stepSize;
-            }
-            
-            float noiseValue = perlin.octaveNoise(worldX * 0.01, worldZ * 0.01, 0, 6, 0.5);
-            float height = noiseValue * 50.0f + 10.0f; // Add base height to ensure visibility
-            
-            vertices.push_back(worldX);
-            vertices.push_back(height);
-            vertices.push_back(worldZ);
-            
-            float h1 = perlin.octaveNoise((worldX + stepSize) * 0.01, worldZ * 0.01, 0, 6, 0.5) * 50.0f;
-            float h2 = perlin.octaveNoise((worldX - stepSize) * 0.01, worldZ * 0.01, 0, 6, 0.5) * 50.0f;
-            float h3 = perlin.octaveNoise(worldX * 0.01, (worldZ + stepSize) * 0.01, 0, 6, 0.5) * 50.0f;
-            float h4 = perlin.octaveNoise(worldX * 0.01, (worldZ - stepSize) * 0.01, 0, 6, 0.5) * 50.0f;
-            
-            glm::vec3 normal = glm::normalize(glm::vec3(h2 - h1, 2.0f * stepSize, h4 - h3));
-            vertices.push_back(normal.x);
-            vertices.push_back(normal.y);
-            vertices.push_back(normal.z);
-            
-            vertices.push_back(static_cast<float>(x) / (vertexResolution - 1));
-            vertices.push_back(static_cast<float>(z) / (vertexResolution - 1));
+    // Heightfield normals need a one-sample apron ring around the grid
+    const int apron = normalSource == NormalSource::HEIGHTFIELD ? 1 : 0;
+    const int sampleResolution = vertexResolution + 2 * apron;
+    const int last = vertexResolution - 1;
+    auto gridOffset = [&](int i) { return i == last ? chunkSize : i * stepSize; };
+    
+    // Grid coordinates along each axis, with edge vertices exactly on chunk
+    // boundaries. Apron samples are computed the way the neighbouring chunk
+    // computes its own vertex there, so shared edges see identical heights.
+    std::vector<float>& worldXs = scratch.worldXs;
+    std::vector<float>& worldZs = scratch.worldZs;
+    worldXs.resize(sampleResolution);
+    worldZs.resize(sampleResolution);
+    for (int i = -apron; i < vertexResolution + apron; ++i) {
+        float originX = basePos.x;
+        float originZ = basePos.z;
+        int cell = i;
+        if (i < 0) {
+            originX = (chunkCoord.x - 1) * chunkSize;
+            originZ = (chunkCoord.y - 1) * chunkSize;
+            cell = last - 1;
+        } else if (i > last) {
+            originX = (chunkCoord.x + 1) * chunkSize;
+            originZ = (chunkCoord.y + 1) * chunkSize;
+            cell = 1;
         }
+        worldXs[i + apron] = originX + gridOffset(cell);
+        worldZs[i + apron] = originZ + gridOffset(cell);
     }
     
-    for (int z = 0; z < vertexResolution - 1; ++z) {
-        for (int x = 0; x < vertexResolution - 1; ++x) {
-            unsigned int topLeft = z * vertexResolution + x;
-            unsigned int topRight = topLeft + 1;
-            unsigned int bottomLeft = (z + 1) * vertexResolution + x;
-            unsigned int bottomRight = bottomLeft + 1;
-            
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
-            
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
+    // Height, slope and color for the whole chunk in one pass; each vertex
+    // looks up its biome weights once and uses them for all three
+    std::vector<BiomeSample>& samples = scratch.samples;
+    samples.resize(sampleResolution * sampleResolution);
+    biomes.sampleGrid(worldXs, worldZs, perlin, samples);
+    
+    std::vector<glm::vec3>& normals = scratch.normals;
+    normals.resize(vertexResolution * vertexResolution);
+    if (normalSource == NormalSource::HEIGHTFIELD) {
+        std::vector<float>& heights = scratch.heights;
+        heights.resize(samples.size());
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            heights[i] = samples[i].height;
         }
+        heightfieldNormals(heights, worldXs, worldZs, normals);
     }
-}
-
-void TerrainChunk::generateMeshWithStitching(const PerlinNoise& perlin, int northLOD, int southLOD, int eastLOD, int westLOD) {
-    // For now, use a simpler approach: ensure edge vertices are generated consistently
-    // This reduces complexity while still providing seamless connections
-    generateMesh(perlin);
-}
-
-void TerrainChunk::uploadMesh() {
-    glBindVertexArray(VAO);
     
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_DYNAMIC_DRAW);
+    // The vertex at (x, z) without the apron ring
+    auto vertexSample = [&](int x, int z) -> const BiomeSample& {
+        return samples[(z + apron) * sampleResolution + (x + apron)];
+    };
+    
+    if (normalSource == NormalSource::ANALYTIC) {
+        // Exact surface normal of y = h(x, z): (-dh/dx, 1, -dh/dz)
+        for (int z = 0; z < vertexResolution; ++z) {
+            for (int x = 0; x < vertexResolution; ++x) {
+                glm::vec2 gradient = vertexSample(x, z).gradient;
+                normals[z * vertexResolution + x] = glm::normalize(glm::vec3(-gradient.x, 1.0f, -gradient.y));
+            }
+        }
+    }
+    
+    float minHeight = vertexSample(0, 0).height;
+    float maxHeight = minHeight;
+    for (int z = 0; z < vertexResolution; ++z) {
+        for (int x = 0; x < vertexResolution; ++x) {
+            minHeight = std::min(minHeight, vertexSample(x, z).height);
+            maxHeight = std::max(maxHeight, vertexSample(x, z).height);
+        }
+    }
+    boundsMin = glm::vec3(basePos.x, minHeight, basePos.z);
+    boundsMax = glm::vec3(basePos.x + chunkSize, maxHeight, basePos.z + chunkSize);
+    vertexCount = static_cast<std::size_t>(vertexResolution) * vertexResolution;
+    triangleCount = getGridTriangleCount();
+    meshError = 0.0f;
     
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_DYNAMIC_DRAW);
+    // The error pass only depends on the heights; the triangles also depend
+    // on the neighbours and are built from it whenever those change
+    if (meshMode == MeshMode::ADAPTIVE) {
+        adaptiveHeights.resize(vertexCount);
+        adaptiveErrors.resize(vertexCount);
+        for (int z = 0; z < vertexResolution; ++z) {
+            for (int x = 0; x < vertexResolution; ++x) {
+                adaptiveHeights[z * vertexResolution + x] = vertexSample(x, z).height;
+            }
+        }
+        rtinErrors(adaptiveHeights, vertexResolution, adaptiveErrors);
+    }
     
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
+    // Vertex buffer formats are written straight into the upload ring when
+    // staging. The mapping is write-only and write-combined, so each vertex
+    // is built locally and stored whole, in order. A debug copy, or a build
+    // off the main thread, goes through scratch instead.
+    if (stage && vertexFormat != VertexFormat::HEIGHT_TILE) {
+        stagedVertices = uploadRing->allocate(vertexCount * vertexSize(vertexFormat));
+    }
     
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    if (vertexFormat == VertexFormat::COMPACT) {
+        heightQuantization = HeightQuantization::fromRange(minHeight, maxHeight);
+        
+        CompactTerrainVertex* out = static_cast<CompactTerrainVertex*>(stagedVertices.data);
+        if (keepCpuMesh || !stage) {
+            compactVertices.resize(vertexCount);
+            out = compactVertices.data();
+        }
+        
+        // Position and texture coordinates are rebuilt from gridIndex in the shader
+        for (int z = 0; z < vertexResolution; ++z) {
+            for (int x = 0; x < vertexResolution; ++x) {
+                const BiomeSample& sample = vertexSample(x, z);
+                const int index = z * vertexResolution + x;
+                CompactTerrainVertex vertex;
+                vertex.height = heightQuantization.encode(sample.height);
+                vertex.gridIndex = static_cast<std::uint16_t>(index);
+                encodeHemiOctahedral(normals[index], vertex.normal);
+                vertex.color = packColor565(sample.color);
+                out[index] = vertex;
+            }
+        }
+    } else if (vertexFormat == VertexFormat::HEIGHT_TILE) {
+        heightQuantization = HeightQuantization::fromRange(minHeight, maxHeight);
+        
+        // The texel's position in the tile is the grid position
+        tileTexels.resize(vertexCount);
+        for (int z = 0; z < vertexResolution; ++z) {
+            for (int x = 0; x < vertexResolution; ++x) {
+                const BiomeSample& sample = vertexSample(x, z);
+                const int index = z * vertexResolution + x;
+                HeightTileTexel& texel = tileTexels[index];
+                texel.height = heightQuantization.encode(sample.height);
+                encodeHemiOctahedral(normals[index], texel.normal);
+                texel.color = packColor565(sample.color);
+            }
+        }
+    } else {
+        TerrainVertex* out = static_cast<TerrainVertex*>(stagedVertices.data);
+        if (keepCpuMesh || !stage) {
+            vertices.resize(vertexCount);
+            out = vertices.data();
+        }
+        
+        for (int z = 0; z < vertexResolution; ++z) {
+            for (int x = 0; x < vertexResolution; ++x) {
+                const BiomeSample& sample = vertexSample(x, z);
+                
+                TerrainVertex vertex;
+                vertex.position = glm::vec3(worldXs[x + apron], sample.height, worldZs[z + apron]);
+                vertex.normal = normals[z * vertexResolution + x];
+                vertex.texCoords = glm::vec2(static_cast<float>(x) / (vertexResolution - 1),
+                                             static_cast<float>(z) / (vertexResolution - 1));
+                vertex.color = packColorRGBA8(sample.color);
+                out[z * vertexResolution + x] = vertex;
+            }
+        }
+    }
     
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    // Quantized heights round to the nearest step, either way
+    if (vertexFormat != VertexFormat::FULL) {
+        boundsMin.y -= 0.5f * heightQuantization.step;
+        boundsMax.y += 0.5f * heightQuantization.step;
+    }
     
-    glBindVertexArray(0);
+    if (keepCpuMesh && stagedVertices.data != nullptr) {
+        const void* kept = vertexFormat == VertexFormat::COMPACT ? static_cast<const void*>(compactVertices.data())
+                                                                 : static_cast<const void*>(vertices.data());
+        std::memcpy(stagedVertices.data, kept, stagedVertices.size);
+    }
 }
 
-void TerrainChunk::render() {
-    if (indices.empty()) {
-        std::cout << "Warning: Trying to render chunk with no indices!" << std::endl;
+void TerrainChunk::uploadMesh(const MeshScratch& scratch, const ChunkIndexCache::IndexBuffer& indices) {
+    if (vertexFormat == VertexFormat::HEIGHT_TILE) {
+        // A new LOD needs a tile of a different size; for the same LOD the
+        // store hands the layer straight back
+        heightTiles->release(tileSlot);
+        tileSlot = heightTiles->allocate(lodLevel);
+        heightTiles->upload(tileSlot, scratch.tileTexels);
+        drawIndices = indices;
         return;
     }
     
+    // Built without staging: the vertices are in scratch
+    if (stagedVertices.data == nullptr) {
+        stagedVertices = uploadRing->allocate(vertexCount * vertexSize(vertexFormat));
+        const void* built = vertexFormat == VertexFormat::COMPACT ? static_cast<const void*>(scratch.compactVertices.data())
+                                                                  : static_cast<const void*>(scratch.vertices.data());
+        std::memcpy(stagedVertices.data, built, stagedVertices.size);
+    }
+    
+    // A new range every time, as the LOD may have changed; releasing first
+    // lets the old range be reused when nothing earlier fits
+    arena->releaseVertices(vertexRange);
+    vertexRange = arena->allocateVertices(vertexCount);
+    uploadRing->copyTo(stagedVertices, arena->getVertexBuffer(), arena->getVertexByteOffset(vertexRange));
+    stagedVertices = {};
+    drawIndices = indices;
     
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    // The GPU copy is now the only one unless a debug copy was asked for
+    if (keepCpuMesh) {
+        keptVertices = scratch.vertices;
+        keptCompactVertices = scratch.compactVertices;
+    }
+}
+
+ChunkIndexCache::IndexBuffer TerrainChunk::buildAdaptiveIndices() {
+    std::vector<unsigned int> triangles = buildAdaptiveTriangles(adaptiveErrors, vertexResolution, adaptiveMaxError, stitchedEdges);
+    triangleCount = triangles.size() / 3;
+    meshError = triangulationError(adaptiveHeights, vertexResolution, triangles);
     
+    arena->releaseIndices(indexRange);
+    indexRange = arena->uploadIndices(triangles);
+    return {vertexResolution, 0, 0, static_cast<GLsizei>(triangles.size()), GL_TRIANGLES, GL_UNSIGNED_INT};
+}
+
+ChunkArena::Draw TerrainChunk::getDraw(const LodMorphRange& morph) const {
+    // A grid that cannot be halved has no coarser vertices to slide onto
+    LodMorphRange range = canStitchEdges(vertexResolution) ? morph : LodMorphRange{};
+    glm::vec3 basePos = getWorldPosition();
+    GLuint firstIndex = indexRange != ArenaAllocator::NONE ? arena->getFirstIndex(indexRange) : arena->getFirstIndex(drawIndices);
+    ChunkAttributes attributes{basePos.x, basePos.z, heightQuantization.base, heightQuantization.step,
+                               static_cast<std::uint32_t>(arena->getFirstVertex(vertexRange)), pinnedEdges,
+                               static_cast<std::uint32_t>(vertexResolution), range.start, range.end};
+    return {drawIndices.mode, static_cast<GLuint>(drawIndices.count), firstIndex, attributes};
+}
+
+HeightTileStore::Instance TerrainChunk::getTileInstance() const {
+    glm::vec3 basePos = getWorldPosition();
+    return {tileSlot, stitchedEdges, pinnedEdges, basePos.x, basePos.z, heightQuantization};
+}
+
+std::size_t TerrainChunk::getRetainedBytes() const {
+    return keptVertices.capacity() * sizeof(TerrainVertex) + keptCompactVertices.capacity() * sizeof(CompactTerrainVertex);
+}
+
+std::size_t TerrainChunk::getAdaptiveBytes() const {
+    return (adaptiveHeights.capacity() + adaptiveErrors.capacity()) * sizeof(float);
 }
 
 void TerrainChunk::setLOD(int lod) {
@@ -150,10 +349,4 @@ glm::vec3 TerrainChunk::getWorldPosition() const {
 float TerrainChunk::getDistanceFrom(const glm::vec3& pos) const {
     glm::vec3 chunkCenter = getWorldPosition() + glm::vec3(chunkSize * 0.5f, 0.0f, chunkSize * 0.5f);
     return glm::length(pos - chunkCenter);
-}
-
-bool TerrainChunk::isVisible(const glm::mat4& viewProjection) const {
-    // Temporarily disable frustum culling to prevent chunks from disappearing
-    // Distance-based culling in DynamicTerrain is sufficient for performance
-    return true;
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "VertexCache.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <unordered_set>
+
+namespace {
+
+// Forsyth's published tuning, for a cache of VERTEX_CACHE_SIZE entries
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+// Vertices in the cache score by recency, the last triangle's three a flat
+// amount so strips do not always win; vertices with few triangles left are
+// boosted so they are finished off instead of stranded
+float vertexScore(int cachePosition, int remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3) {
+            score = LAST_TRIANGLE_SCORE;
+        } else {
+            const float scale = 1.0f / (VERTEX_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scale, CACHE_DECAY_POWER);
+        }
+    }
+    return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+}
+
+} // namespace
+
+VertexCacheStats measureVertexCache(std::span<const unsigned int> indices, IndexEncoding encoding,
+                                    unsigned int restartIndex, int cacheSize) {
+    VertexCacheStats stats;
+    std::deque<unsigned int> fifo;
+    std::unordered_set<unsigned int> distinct;
+    auto fetch = [&](unsigned int index) {
+        distinct.insert(index);
+        if (std::find(fifo.begin(), fifo.end(), index) != fifo.end()) {
+            return;
+        }
+        stats.misses++;
+        fifo.push_back(index);
+        if (static_cast<int>(fifo.size()) > cacheSize) {
+            fifo.pop_front();
+        }
+    };
+    
+    if (encoding == IndexEncoding::TRIANGLES) {
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+            fetch(indices[i]);
+            fetch(indices[i + 1]);
+            fetch(indices[i + 2]);
+            if (indices[i] != indices[i + 1] && indices[i + 1] != indices[i + 2] && indices[i] != indices[i + 2]) {
+                stats.triangles++;
+            }
+        }
+    } else {
+        // Each index after the first two of a strip adds a triangle with the
+        // two before it; GL skips the collapsed ones
+        std::size_t stripLength = 0;
+        for (std::size_t i = 0; i < indices.size(); ++i) {
+            if (indices[i] == restartIndex) {
+                stripLength = 0;
+                continue;
+            }
+            fetch(indices[i]);
+            if (++stripLength >= 3 && indices[i] != indices[i - 1] && indices[i] != indices[i - 2] &&
+                indices[i - 1] != indices[i - 2]) {
+                stats.triangles++;
+            }
+        }
+    }
+    stats.vertices = distinct.size();
+    return stats;
+}
+
+std::vector<unsigned int> optimizeVertexCache(std::span<const unsigned int> triangles, std::size_t vertexCount) {
+    const std::size_t triangleCount = triangles.size() / 3;
+    
+    // Triangles of each vertex in one array; the first remaining[v] entries
+    // of a vertex's range are the ones not drawn yet
+    std::vector<int> remaining(vertexCount, 0);
+    for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+        remaining[triangles[i]]++;
+    }
+    std::vector<std::size_t> firstTriangle(vertexCount + 1, 0);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+    }
+    std::vector<std::size_t> vertexTriangles(triangleCount * 3);
+    std::vector<std::size_t> filled(firstTriangle.begin(), firstTriangle.end() - 1);
+    for (std::size_t i = 0; i < triangleCount * 3; ++i) {
+        vertexTriangles[filled[triangles[i]]++] = i / 3;
+    }
+    
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        score[v] = vertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<char> drawn(triangleCount, 0);
+    for (std::size_t t = 0; t < triangleCount; ++t) {
+        triangleScore[t] = score[triangles[3 * t]] + score[triangles[3 * t + 1]] + score[triangles[3 * t + 2]];
+    }
+    
+    std::vector<unsigned int> ordered;
+    ordered.reserve(triangleCount * 3);
+    std::vector<unsigned int> cache, nextCache;
+    std::size_t nextUndrawn = 0;
+    std::size_t best = triangleCount;
+    for (std::size_t count = 0; count < triangleCount; ++count) {
+        // Nothing in the cache has triangles left: start again at the first
+        // undrawn one, which for grids is next to where the last run began
+        if (best == triangleCount) {
+            while (drawn[nextUndrawn]) {
+                ++nextUndrawn;
+            }
+            best = nextUndrawn;
+        }
+        
+        drawn[best] = 1;
+        nextCache.clear();
+        for (int k = 0; k < 3; ++k) {
+            const unsigned int v = triangles[3 * best + k];
+            ordered.push_back(v);
+            if (std::find(nextCache.begin(), nextCache.end(), v) != nextCache.end()) {
+                continue; // Collapsed triangle
+            }
+            nextCache.push_back(v);
+            
+            // Swap the triangle out of the vertex's undrawn range
+            std::size_t* begin = vertexTriangles.data() + firstTriangle[v];
+            std::size_t* end = begin + remaining[v];
+            std::iter_swap(std::find(begin, end, best), end - 1);
+            remaining[v]--;
+        }
+        
+        // The triangle's vertices move to the front; whatever falls past the
+        // end of the cache is scored as uncached once more
+        for (unsigned int v : cache) {
+            if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end()) {
+                nextCache.push_back(v);
+            }
+        }
+        for (std::size_t i = 0; i < nextCache.size(); ++i) {
+            const unsigned int v = nextCache[i];
+            cachePosition[v] = i < VERTEX_CACHE_SIZE ? static_cast<int>(i) : -1;
+            score[v] = vertexScore(cachePosition[v], remaining[v]);
+        }
+        
+        // Only triangles of these vertices changed score; the best of them
+        // is drawn next
+        best = triangleCount;
+        float bestScore = -1.0f;
+        for (unsigned int v : nextCache) {
+            for (int i = 0; i < remaining[v]; ++i) {
+                const std::size_t t = vertexTriangles[firstTriangle[v] + i];
+                triangleScore[t] = score[triangles[3 * t]] + score[triangles[3 * t + 1]] + score[triangles[3 * t + 2]];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    best = t;
+                }
+            }
+        }
+        
+        nextCache.resize(std::min<std::size_t>(nextCache.size(), VERTEX_CACHE_SIZE));
+        std::swap(cache, nextCache);
+    }
+    return ordered;
+}
\ No newline at end of file
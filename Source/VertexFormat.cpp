@@ -0,0 +1,94 @@
+#include "VertexFormat.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+std::uint32_t quantizeUnit(float value, std::uint32_t levels) {
+    return static_cast<std::uint32_t>(std::clamp(value, 0.0f, 1.0f) * levels + 0.5f);
+}
+
+std::int8_t quantizeSigned(float value) {
+    return static_cast<std::int8_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+}
+
+// Matches GL's snorm conversion for GL_BYTE attributes
+float snorm8(std::int8_t value) {
+    return std::max(static_cast<float>(value) / 127.0f, -1.0f);
+}
+
+} // namespace
+
+HeightQuantization HeightQuantization::fromRange(float minHeight, float maxHeight) {
+    HeightQuantization q;
+    q.step = MIN_STEP;
+    for (;;) {
+        q.base = std::floor(minHeight / q.step) * q.step;
+        if ((maxHeight - q.base) / q.step <= 65535.0f) break;
+        q.step *= 2.0f;
+    }
+    return q;
+}
+
+std::uint16_t HeightQuantization::encode(float height) const {
+    float steps = std::round((height - base) / step);
+    return static_cast<std::uint16_t>(std::clamp(steps, 0.0f, 65535.0f));
+}
+
+VertexFormat parseVertexFormat(const std::string& name) {
+    if (name == "full") return VertexFormat::FULL;
+    if (name == "compact") return VertexFormat::COMPACT;
+    if (name == "heightTile") return VertexFormat::HEIGHT_TILE;
+    throw std::runtime_error("Unknown vertex format: " + name);
+}
+
+const char* vertexFormatName(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::COMPACT: return "compact";
+        case VertexFormat::HEIGHT_TILE: return "heightTile";
+        default: return "full";
+    }
+}
+
+std::size_t vertexSize(VertexFormat format) {
+    switch (format) {
+        case VertexFormat::COMPACT: return sizeof(CompactTerrainVertex);
+        case VertexFormat::HEIGHT_TILE: return sizeof(HeightTileTexel);
+        default: return sizeof(TerrainVertex);
+    }
+}
+
+std::uint32_t packColorRGBA8(const glm::vec3& color) {
+    // Memory order r, g, b, a on little-endian hosts
+    return quantizeUnit(color.r, 255) | (quantizeUnit(color.g, 255) << 8) |
+           (quantizeUnit(color.b, 255) << 16) | (255u << 24);
+}
+
+std::uint16_t packColor565(const glm::vec3& color) {
+    return static_cast<std::uint16_t>((quantizeUnit(color.r, 31) << 11) |
+                                      (quantizeUnit(color.g, 63) << 5) |
+                                      quantizeUnit(color.b, 31));
+}
+
+glm::vec3 unpackColor565(std::uint16_t color) {
+    return glm::vec3((color >> 11) / 31.0f, ((color >> 5) & 63) / 63.0f, (color & 31) / 31.0f);
+}
+
+void encodeHemiOctahedral(const glm::vec3& normal, std::int8_t out[2]) {
+    // Project onto the |x| + |z| <= 1 diamond, then rotate it 45 degrees so
+    // it fills the whole [-1, 1] square
+    float sum = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    float px = normal.x / sum;
+    float pz = normal.z / sum;
+    out[0] = quantizeSigned(px + pz);
+    out[1] = quantizeSigned(px - pz);
+}
+
+glm::vec3 decodeHemiOctahedral(const std::int8_t encoded[2]) {
+    float ex = snorm8(encoded[0]);
+    float ey = snorm8(encoded[1]);
+    float px = (ex + ey) * 0.5f;
+    float pz = (ex - ey) * 0.5f;
+    return glm::normalize(glm::vec3(px, 1.0f - std::abs(px) - std::abs(pz), pz));
+}
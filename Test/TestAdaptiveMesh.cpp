@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "AdaptiveMesh.h"
+#include "Biome.h"
+#include "GridIndices.h"
+
+namespace {
+
+const int RESOLUTION = 65;
+const float CHUNK_SIZE = 64.0f;
+const float MAX_ERROR = 0.5f; // Default terrain.adaptiveMaxError
+
+std::vector<float> sampleHeights(int resolution, float (*height)(float, float)) {
+    std::vector<float> heights(resolution * resolution);
+    for (int z = 0; z < resolution; ++z) {
+        for (int x = 0; x < resolution; ++x) {
+            heights[z * resolution + x] = height(static_cast<float>(x), static_cast<float>(z));
+        }
+    }
+    return heights;
+}
+
+float gentleHills(float x, float z) {
+    return 4.0f * std::sin(x * 0.05f) * std::cos(z * 0.04f) + 0.02f * x;
+}
+
+float rockyRidges(float x, float z) {
+    return 30.0f * std::sin(x * 0.7f) * std::cos(z * 0.9f) + 10.0f * std::sin((x + z) * 1.3f);
+}
+
+std::vector<unsigned int> adaptiveMesh(const std::vector<float>& heights, int resolution, float maxError,
+                                       unsigned int stitchedEdges = 0) {
+    std::vector<float> errors(heights.size());
+    rtinErrors(heights, resolution, errors);
+    return buildAdaptiveTriangles(errors, resolution, maxError, stitchedEdges);
+}
+
+// Twice the area covered, and every edge inside the chunk used once in each
+// direction; boundary edges are returned as (from, to) vertex pairs
+int checkConforming(const std::vector<unsigned int>& triangles, int resolution,
+                    std::vector<std::pair<unsigned int, unsigned int>>& boundary) {
+    std::map<std::pair<unsigned int, unsigned int>, int> directed;
+    int doubleArea = 0;
+    for (std::size_t t = 0; t < triangles.size(); t += 3) {
+        unsigned int v[3] = {triangles[t], triangles[t + 1], triangles[t + 2]};
+        int ax = v[0] % resolution, az = v[0] / resolution;
+        int bx = v[1] % resolution, bz = v[1] / resolution;
+        int cx = v[2] % resolution, cz = v[2] / resolution;
+        int cross = (bx - ax) * (cz - az) - (bz - az) * (cx - ax);
+        EXPECT_LT(cross, 0) << "Triangle " << t / 3 << " is degenerate or wound the wrong way";
+        doubleArea -= cross;
+        for (int i = 0; i < 3; ++i) {
+            directed[{v[i], v[(i + 1) % 3]}]++;
+        }
+    }
+    for (const auto& [edge, count] : directed) {
+        EXPECT_EQ(count, 1);
+        if (directed.find({edge.second, edge.first}) == directed.end()) {
+            boundary.push_back(edge);
+        }
+    }
+    return doubleArea;
+}
+
+} // namespace
+
+TEST(AdaptiveMeshTest, ParseMode) {
+    EXPECT_EQ(parseMeshMode("grid"), MeshMode::GRID);
+    EXPECT_EQ(parseMeshMode("adaptive"), MeshMode::ADAPTIVE);
+    EXPECT_STREQ(meshModeName(MeshMode::ADAPTIVE), "adaptive");
+    EXPECT_THROW(parseMeshMode("rtin"), std::runtime_error);
+    
+    EXPECT_TRUE(canBuildAdaptiveMesh(65));
+    EXPECT_TRUE(canBuildAdaptiveMesh(2));
+    EXPECT_FALSE(canBuildAdaptiveMesh(64));
+}
+
+TEST(AdaptiveMeshTest, ZeroErrorKeepsEveryVertex) {
+    std::vector<float> heights = sampleHeights(RESOLUTION, rockyRidges);
+    std::vector<unsigned int> triangles = adaptiveMesh(heights, RESOLUTION, 0.0f);
+    EXPECT_EQ(triangles.size(), buildGridTriangles(RESOLUTION).size());
+    EXPECT_FLOAT_EQ(triangulationError(heights, RESOLUTION, triangles), 0.0f);
+}
+
+TEST(AdaptiveMeshTest, ErrorStaysWithinBound) {
+    for (float maxError : {0.1f, 0.5f, 2.0f}) {
+        for (auto height : {gentleHills, rockyRidges}) {
+            std::vector<float> heights = sampleHeights(RESOLUTION, height);
+            std::vector<unsigned int> triangles = adaptiveMesh(heights, RESOLUTION, maxError);
+            EXPECT_LE(triangulationError(heights, RESOLUTION, triangles), maxError) << "maxError " << maxError;
+        }
+    }
+}
+
+TEST(AdaptiveMeshTest, MeshIsConformingWithFullEdges) {
+    std::vector<float> heights = sampleHeights(RESOLUTION, gentleHills);
+    std::vector<unsigned int> triangles = adaptiveMesh(heights, RESOLUTION, MAX_ERROR);
+    
+    // No T-junctions inside, and the boundary is every unit edge segment, as
+    // on the grid, so any neighbour meets it exactly
+    std::vector<std::pair<unsigned int, unsigned int>> boundary;
+    const int cells = RESOLUTION - 1;
+    EXPECT_EQ(checkConforming(triangles, RESOLUTION, boundary), 2 * cells * cells);
+    EXPECT_EQ(boundary.size(), 4u * cells);
+    for (const auto& [from, to] : boundary) {
+        int dx = std::abs(static_cast<int>(from % RESOLUTION) - static_cast<int>(to % RESOLUTION));
+        int dz = std::abs(static_cast<int>(from / RESOLUTION) - static_cast<int>(to / RESOLUTION));
+        EXPECT_EQ(dx + dz, 1);
+    }
+}
+
+TEST(AdaptiveMeshTest, StitchedEdgesFollowCoarserGrid) {
+    std::vector<float> heights = sampleHeights(RESOLUTION, rockyRidges);
+    const int last = RESOLUTION - 1;
+    for (unsigned int stitchedEdges = 0; stitchedEdges < EDGE_MASK_COUNT; ++stitchedEdges) {
+        std::vector<unsigned int> triangles = adaptiveMesh(heights, RESOLUTION, MAX_ERROR, stitchedEdges);
+        std::vector<std::pair<unsigned int, unsigned int>> boundary;
+        EXPECT_EQ(checkConforming(triangles, RESOLUTION, boundary), 2 * last * last);
+        
+        // Stitched edges step two cells at a time between even vertices
+        for (const auto& [from, to] : boundary) {
+            int fx = from % RESOLUTION, fz = from / RESOLUTION;
+            int tx = to % RESOLUTION, tz = to / RESOLUTION;
+            bool stitched = (fz == 0 && tz == 0 && (stitchedEdges & EDGE_NORTH)) ||
+                            (fz == last && tz == last && (stitchedEdges & EDGE_SOUTH)) ||
+                            (fx == 0 && tx == 0 && (stitchedEdges & EDGE_WEST)) ||
+                            (fx == last && tx == last && (stitchedEdges & EDGE_EAST));
+            EXPECT_EQ(std::abs(fx - tx) + std::abs(fz - tz), stitched ? 2 : 1) << "mask " << stitchedEdges;
+            if (stitched) {
+                EXPECT_EQ((fx | fz | tx | tz) % 2, 0);
+            }
+        }
+    }
+}
+
+TEST(AdaptiveMeshTest, FlatChunkOnlyRefinesEdges) {
+    std::vector<float> heights(RESOLUTION * RESOLUTION, 12.0f);
+    std::vector<unsigned int> triangles = adaptiveMesh(heights, RESOLUTION, MAX_ERROR);
+    std::size_t gridTriangles = buildGridTriangles(RESOLUTION).size() / 3;
+    
+    // Keeping every edge vertex costs most of what is left
+    EXPECT_LE(triangles.size() / 3 * 8, gridTriangles);
+    
+    // A single-cell grid is just its two triangles
+    std::vector<float> cell(4, 0.0f);
+    EXPECT_EQ(adaptiveMesh(cell, 2, MAX_ERROR).size(), 6u);
+}
+
+TEST(AdaptiveMeshTest, BiomeChunkTriangleCounts) {
+    // Real chunks from the default generator: check the reduction per
+    // biome against the uniform LOD 0 grid
+    BiomeGenerator biomes(12345);
+    PerlinNoise perlin(42);
+    const std::size_t gridTriangles = buildGridTriangles(RESOLUTION).size() / 3;
+    
+    std::map<BiomeType, std::pair<std::size_t, int>> perBiome; // Triangles, chunks
+    std::vector<float> xs(RESOLUTION), zs(RESOLUTION), heights(RESOLUTION * RESOLUTION);
+    std::vector<BiomeSample> samples(RESOLUTION * RESOLUTION);
+    for (int cz = -20; cz < 20; cz += 4) {
+        for (int cx = -20; cx < 20; cx += 4) {
+            for (int i = 0; i < RESOLUTION; ++i) {
+                xs[i] = cx * CHUNK_SIZE + i * CHUNK_SIZE / (RESOLUTION - 1);
+                zs[i] = cz * CHUNK_SIZE + i * CHUNK_SIZE / (RESOLUTION - 1);
+            }
+            biomes.sampleGrid(xs, zs, perlin, samples);
+            for (std::size_t i = 0; i < samples.size(); ++i) {
+                heights[i] = samples[i].height;
+            }
+            std::vector<unsigned int> triangles = adaptiveMesh(heights, RESOLUTION, MAX_ERROR);
+            float error = triangulationError(heights, RESOLUTION, triangles);
+            EXPECT_LE(error, MAX_ERROR);
+            
+            BiomeType biome = biomes.getBiome(xs[RESOLUTION / 2], zs[RESOLUTION / 2]);
+            perBiome[biome].first += triangles.size() / 3;
+            perBiome[biome].second++;
+        }
+    }
+    
+    for (const auto& [biome, totals] : perBiome) {
+        double mean = static_cast<double>(totals.first) / totals.second;
+        if (biome == BiomeType::DESERT || biome == BiomeType::TUNDRA) {
+            EXPECT_GE(gridTriangles / mean, 5.0);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "ArenaAllocator.h"
+
+namespace {
+
+// Applies compact()'s moves to a copy of memory the way ChunkArena does,
+// into a fresh buffer
+std::vector<int> relocate(const std::vector<int>& memory, const std::vector<ArenaAllocator::Move>& moves, std::size_t capacity) {
+    std::vector<int> fresh(capacity, -1);
+    for (const ArenaAllocator::Move& move : moves) {
+        std::copy_n(memory.begin() + move.from, move.size, fresh.begin() + move.to);
+    }
+    return fresh;
+}
+
+} // namespace
+
+TEST(ArenaAllocatorTest, FirstFitReusesReleasedRanges) {
+    ArenaAllocator arena(1000);
+    ArenaAllocator::Handle a = arena.allocate(100);
+    ArenaAllocator::Handle b = arena.allocate(50);
+    ArenaAllocator::Handle c = arena.allocate(100);
+    EXPECT_EQ(arena.getOffset(a), 0u);
+    EXPECT_EQ(arena.getOffset(b), 100u);
+    EXPECT_EQ(arena.getOffset(c), 150u);
+    EXPECT_EQ(arena.getUsed(), 250u);
+    
+    // The hole b leaves is the first that fits
+    arena.release(b);
+    ArenaAllocator::Handle d = arena.allocate(40);
+    EXPECT_EQ(arena.getOffset(d), 100u);
+    EXPECT_EQ(arena.getOffset(arena.allocate(20)), 250u);
+    EXPECT_EQ(arena.getFreeRangeCount(), 2u);
+    
+    // Released handles are handed out again
+    EXPECT_EQ(d, b);
+    EXPECT_EQ(arena.getAllocationCount(), 4u);
+}
+
+TEST(ArenaAllocatorTest, ReleaseMergesNeighbours) {
+    ArenaAllocator arena(300);
+    ArenaAllocator::Handle a = arena.allocate(100);
+    ArenaAllocator::Handle b = arena.allocate(100);
+    ArenaAllocator::Handle c = arena.allocate(100);
+    EXPECT_EQ(arena.allocate(1), ArenaAllocator::NONE);
+    
+    arena.release(a);
+    arena.release(c);
+    EXPECT_EQ(arena.getFreeRangeCount(), 2u);
+    arena.release(b);
+    EXPECT_EQ(arena.getFreeRangeCount(), 1u);
+    EXPECT_EQ(arena.getLargestFree(), 300u);
+    EXPECT_EQ(arena.getUsed(), 0u);
+    
+    // Empty allocations take no space and releasing NONE does nothing
+    ArenaAllocator::Handle empty = arena.allocate(0);
+    EXPECT_NE(empty, ArenaAllocator::NONE);
+    arena.release(empty);
+    arena.release(ArenaAllocator::NONE);
+    EXPECT_EQ(arena.getLargestFree(), 300u);
+}
+
+TEST(ArenaAllocatorTest, CompactPacksLiveRanges) {
+    ArenaAllocator arena(400);
+    ArenaAllocator::Handle a = arena.allocate(100);
+    ArenaAllocator::Handle b = arena.allocate(100);
+    ArenaAllocator::Handle c = arena.allocate(100);
+    ArenaAllocator::Handle d = arena.allocate(100);
+    arena.release(a);
+    arena.release(c);
+    
+    // Enough space in total, but not in one piece
+    EXPECT_EQ(arena.allocate(150), ArenaAllocator::NONE);
+    std::vector<ArenaAllocator::Move> moves = arena.compact();
+    ASSERT_EQ(moves.size(), 2u);
+    EXPECT_EQ(moves[0].from, 100u);
+    EXPECT_EQ(moves[0].to, 0u);
+    EXPECT_EQ(moves[1].from, 300u);
+    EXPECT_EQ(moves[1].to, 100u);
+    EXPECT_EQ(arena.getOffset(b), 0u);
+    EXPECT_EQ(arena.getOffset(d), 100u);
+    EXPECT_EQ(arena.getFreeRangeCount(), 1u);
+    EXPECT_EQ(arena.getOffset(arena.allocate(150)), 200u);
+    
+    // Neighbours that move together are one copy
+    ArenaAllocator packed(300);
+    packed.allocate(100);
+    packed.allocate(100);
+    moves = packed.compact();
+    ASSERT_EQ(moves.size(), 1u);
+    EXPECT_EQ(moves[0].size, 200u);
+}
+
+TEST(ArenaAllocatorTest, GrowExtendsTheLastFreeRange) {
+    ArenaAllocator arena(100);
+    ArenaAllocator::Handle a = arena.allocate(60);
+    arena.allocate(40);
+    arena.release(a);
+    arena.grow(200);
+    EXPECT_EQ(arena.getCapacity(), 200u);
+    EXPECT_EQ(arena.getFreeRangeCount(), 2u);
+    EXPECT_EQ(arena.getOffset(arena.allocate(100)), 100u);
+    
+    // Never shrinks
+    arena.grow(50);
+    EXPECT_EQ(arena.getCapacity(), 200u);
+    
+    // An arena may start empty
+    ArenaAllocator empty;
+    EXPECT_EQ(empty.allocate(1), ArenaAllocator::NONE);
+    empty.grow(10);
+    EXPECT_EQ(empty.getOffset(empty.allocate(10)), 0u);
+}
+
+TEST(ArenaAllocatorTest, ChunkChurnKeepsContents) {
+    // Chunks of every LOD of a 65 x 65 grid coming and going, with each
+    // range's contents tagged by its handle. Whenever an allocation fails
+    // the arena is compacted and grown as ChunkArena does it.
+    const std::size_t sizes[] = {65 * 65, 33 * 33, 17 * 17, 9 * 9, 5 * 5, 3 * 3};
+    ArenaAllocator arena(1 << 16);
+    std::vector<int> memory(arena.getCapacity(), -1);
+    std::vector<ArenaAllocator::Handle> live;
+    unsigned int state = 12345;
+    auto random = [&state]() { return (state = state * 1664525u + 1013904223u) >> 8; };
+    std::size_t peakUsed = 0;
+    
+    for (int step = 0; step < 20000; ++step) {
+        if (!live.empty() && random() % 2 == 0) {
+            std::size_t victim = random() % live.size();
+            arena.release(live[victim]);
+            live.erase(live.begin() + victim);
+            continue;
+        }
+        
+        std::size_t size = sizes[random() % 6];
+        ArenaAllocator::Handle handle = arena.allocate(size);
+        if (handle == ArenaAllocator::NONE) {
+            std::size_t capacity = arena.getCapacity();
+            while (arena.getUsed() + size > capacity - capacity / 4) {
+                capacity *= 2;
+            }
+            std::vector<ArenaAllocator::Move> moves = arena.compact();
+            arena.grow(capacity);
+            memory = relocate(memory, moves, capacity);
+            handle = arena.allocate(size);
+            ASSERT_NE(handle, ArenaAllocator::NONE);
+        }
+        std::fill_n(memory.begin() + arena.getOffset(handle), size, handle);
+        live.push_back(handle);
+        peakUsed = std::max(peakUsed, arena.getUsed());
+    }
+    
+    std::size_t used = 0;
+    for (ArenaAllocator::Handle handle : live) {
+        used += arena.getSize(handle);
+        for (std::size_t i = 0; i < arena.getSize(handle); ++i) {
+            ASSERT_EQ(memory[arena.getOffset(handle) + i], handle);
+        }
+    }
+    EXPECT_EQ(used, arena.getUsed());
+    EXPECT_EQ(live.size(), arena.getAllocationCount());
+    
+    EXPECT_LE(arena.getCapacity(), 4 * peakUsed);
+}
\ No newline at end of file
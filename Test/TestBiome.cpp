@@ -73,4 +73,270 @@ TEST_F(BiomeTest, DifferentBiomes) {
     
     // Should find at least 2 different biomes in this range
     EXPECT_GE(foundBiomes.size(), 2);
+}
+
+TEST_F(BiomeTest, FusedHeightMatchesSeparateLayers) {
+    // Reference: the independent octave sums the fused kernel replaces
+    auto reference = [&](float x, float z, const BiomeParams& params) {
+        float continent = heightNoise->octaveNoise2D(x * 0.002f, z * 0.002f, 2, 0.4f);
+        float medium = heightNoise->octaveNoise2D(x * 0.005f, z * 0.005f, 4, params.roughness);
+        float detail = heightNoise->octaveNoise2D(x * 0.01f, z * 0.01f, 6, params.roughness);
+        return continent * 0.5f + medium * 0.35f + detail * 0.15f;
+    };
+    
+    for (int i = 0; i < 40; ++i) {
+        float x = -3000.0f + i * 157.3f;
+        float z = 1200.0f - i * 91.7f;
+        BiomeHeights heights = biomeGen->generateHeights(x, z, *heightNoise);
+        
+        float blended = 0.0f;
+        for (int b = 0; b < heights.weights.count; ++b) {
+            int id = heights.weights.biomes[b];
+            BiomeParams params = biomeGen->getBiomeParams(id);
+            const std::string& name = biomeGen->getBiomeTable().names[id];
+            if (name != "desert" && name != "mountains") {
+                EXPECT_FLOAT_EQ(heights.heights[b], reference(x, z, params) * params.heightScale);
+            }
+            blended += heights.heights[b] * heights.weights.weights[b];
+        }
+        EXPECT_FLOAT_EQ(biomeGen->generateHeight(x, z, *heightNoise), blended);
+    }
+}
+
+TEST_F(BiomeTest, ClimateRasterMatchesNoiseAtNodes) {
+    ClimateRaster raster(12345, 1, [](float, float) { return 0; });
+    for (int i = -20; i <= 20; ++i) {
+        float x = i * 37 * ClimateRaster::CELL_SIZE;
+        float z = (5 - i) * 11 * ClimateRaster::CELL_SIZE;
+        ClimateSample sample = raster.sample(x, z);
+        
+        EXPECT_FLOAT_EQ(sample.temperature, raster.temperatureAt(x, z));
+        EXPECT_FLOAT_EQ(sample.moisture, raster.moistureAt(x, z));
+    }
+}
+
+TEST_F(BiomeTest, ClimateRasterInterpolation) {
+    // Between nodes the raster stays close to the exact fields, and its
+    // gradient points the same way as a finite difference of them
+    ClimateRaster raster(12345, 1, [](float, float) { return 0; });
+    for (int i = 0; i < 200; ++i) {
+        float x = -5000.0f + i * 51.37f;
+        float z = 3000.0f - i * 23.91f;
+        ClimateSample sample = raster.sample(x, z);
+        
+        EXPECT_NEAR(sample.temperature, raster.temperatureAt(x, z), 0.01f);
+        EXPECT_NEAR(sample.moisture, raster.moistureAt(x, z), 0.01f);
+        
+        float dx = (raster.temperatureAt(x + 4.0f, z) - raster.temperatureAt(x - 4.0f, z)) / 8.0f;
+        float dz = (raster.temperatureAt(x, z + 4.0f) - raster.temperatureAt(x, z - 4.0f)) / 8.0f;
+        EXPECT_NEAR(sample.temperatureGradient.x, dx, 1e-3f);
+        EXPECT_NEAR(sample.temperatureGradient.y, dz, 1e-3f);
+    }
+    EXPECT_LE(raster.tileCount(), ClimateRaster::MAX_TILES);
+}
+
+TEST_F(BiomeTest, BiomeWeightsNormalized) {
+    for (int i = 0; i < 500; ++i) {
+        BiomeWeights weights = biomeGen->getBiomeWeights(-4000.0f + i * 16.3f, 2500.0f - i * 9.1f);
+        ASSERT_GE(weights.count, 1);
+        
+        float total = 0.0f;
+        for (int b = 0; b < weights.count; ++b) {
+            EXPECT_GE(weights.biomes[b], 0);
+            EXPECT_LT(weights.biomes[b], biomeGen->getBiomeTable().size());
+            EXPECT_GT(weights.weights[b], 0.0f);
+            if (b > 0) {
+                EXPECT_GE(weights.weights[b - 1], weights.weights[b]);
+            }
+            total += weights.weights[b];
+        }
+        EXPECT_NEAR(total, 1.0f, 1e-5f);
+    }
+}
+
+TEST_F(BiomeTest, BiomeAgreesWithBlendWeights) {
+    // Walk across boundaries: the reported biome is the one weighted most
+    for (int i = 0; i < 2000; ++i) {
+        float x = -4000.0f + i * 3.7f;
+        float z = 1800.0f - i * 2.9f;
+        BiomeWeights weights = biomeGen->getBiomeWeights(x, z);
+        EXPECT_EQ(biomeGen->getBiomeId(x, z), weights.biomes[0]);
+        
+        BiomeType primary, secondary;
+        biomeGen->getBiomeBlend(x, z, primary, secondary);
+        EXPECT_EQ(biomeGen->getBiome(x, z), primary);
+    }
+}
+
+TEST_F(BiomeTest, BlendContinuousAcrossBoundary) {
+    // Walk lines through several biomes; the height should never jump
+    // more than the terrain's own slope allows between adjacent samples
+    const float step = 0.5f;
+    int boundaries = 0;
+    for (float z : {0.0f, 777.0f, -1500.0f}) {
+        float previous = biomeGen->generateHeight(0.0f, z, *heightNoise);
+        int previousBiome = biomeGen->getBiomeWeights(0.0f, z).biomes[0];
+        for (float x = step; x < 8000.0f; x += step) {
+            float height = biomeGen->generateHeight(x, z, *heightNoise);
+            EXPECT_LT(std::abs(height - previous), 2.0f) << "at x = " << x << ", z = " << z;
+            previous = height;
+            
+            int biome = biomeGen->getBiomeWeights(x, z).biomes[0];
+            boundaries += biome != previousBiome;
+            previousBiome = biome;
+        }
+    }
+    EXPECT_GT(boundaries, 0);
+}
+
+TEST_F(BiomeTest, DefaultTableMatchesClimateQuadrants) {
+    // Nearest climate center reproduces the original warm/wet split
+    BiomeTable table;
+    ASSERT_EQ(table.size(), 4);
+    for (float t = -1.0f; t <= 1.0f; t += 0.07f) {
+        for (float m = -1.0f; m <= 1.0f; m += 0.07f) {
+            if (std::abs(t - 0.3f) < 1e-3f || std::abs(m) < 1e-3f) continue;
+            const char* expected = t > 0.3f ? (m > 0 ? "forest" : "desert") : (m > 0 ? "tundra" : "mountains");
+            EXPECT_EQ(table.classify(t, m), table.findId(expected)) << "t = " << t << ", m = " << m;
+        }
+    }
+    EXPECT_EQ(table.findId("mountains"), 2);
+    EXPECT_EQ(table.findId("swamp"), -1);
+}
+
+TEST_F(BiomeTest, TableFromConfig) {
+    // Any number of biomes; ids follow the (alphabetical) config order
+    auto biome = [](float heightScale, glm::vec2 climate, const std::string& feature) {
+        BiomeConfig config = {};
+        config.heightScale = heightScale;
+        config.roughness = 0.5f;
+        config.colorThreshold1 = 10.0f;
+        config.colorThreshold2 = 20.0f;
+        config.climate = climate;
+        config.feature = feature;
+        return config;
+    };
+    std::map<std::string, BiomeConfig> biomes = {
+        {"alpine", biome(90.0f, glm::vec2(-0.8f, 0.0f), "peaks")},
+        {"beach", biome(5.0f, glm::vec2(0.0f, 0.0f), "none")},
+        {"dunes", biome(20.0f, glm::vec2(0.8f, -0.8f), "dunes")},
+        {"jungle", biome(35.0f, glm::vec2(0.8f, 0.8f), "none")},
+        {"steppe", biome(15.0f, glm::vec2(0.0f, -0.8f), "none")}
+    };
+    BiomeTable table(biomes);
+    ASSERT_EQ(table.size(), 5);
+    EXPECT_EQ(table.findId("dunes"), 2);
+    EXPECT_EQ(table.feature[0], BiomeFeature::PEAKS);
+    EXPECT_FLOAT_EQ(table.heightScale[1], 5.0f);
+    EXPECT_EQ(table.classify(0.05f, 0.02f), 1);
+    
+    BiomeGenerator generator(12345, table);
+    std::set<int> seen;
+    for (int i = 0; i < 400; ++i) {
+        BiomeWeights weights = generator.getBiomeWeights(-8000.0f + i * 40.0f, 3000.0f - i * 23.0f);
+        for (int b = 0; b < weights.count; ++b) {
+            ASSERT_LT(weights.biomes[b], 5);
+            seen.insert(weights.biomes[b]);
+        }
+    }
+    EXPECT_GE(seen.size(), 3);
+    
+    biomes["beach"].feature = "cliffs";
+    EXPECT_THROW(BiomeTable{biomes}, std::runtime_error);
+    
+    // No configured biomes falls back to the built-in table
+    EXPECT_EQ(BiomeTable(std::map<std::string, BiomeConfig>()).size(), 4);
+}
+
+TEST_F(BiomeTest, BiomeTypeMapsByName) {
+    // Two built-in biomes under ids that differ from their BiomeType, no
+    // forest, and a biome BiomeType has no value for
+    auto biome = [](float heightScale, glm::vec2 climate) {
+        BiomeConfig config = {};
+        config.heightScale = heightScale;
+        config.roughness = 0.5f;
+        config.colorThreshold1 = 10.0f;
+        config.colorThreshold2 = 20.0f;
+        config.climate = climate;
+        config.feature = "none";
+        return config;
+    };
+    BiomeTable table({
+        {"alpine", biome(90.0f, glm::vec2(-1.0f, -1.0f))},
+        {"desert", biome(20.0f, glm::vec2(1.3f, -1.0f))},
+        {"tundra", biome(40.0f, glm::vec2(-1.0f, 1.0f))}
+    });
+    BiomeGenerator generator(12345, table);
+    
+    EXPECT_FLOAT_EQ(generator.getBiomeParams(BiomeType::DESERT).heightScale, 20.0f);
+    EXPECT_FLOAT_EQ(generator.getBiomeParams(BiomeType::TUNDRA).heightScale, 40.0f);
+    EXPECT_THROW(generator.getBiomeParams(BiomeType::FOREST), std::out_of_range);
+    
+    std::map<std::string, int> seen;
+    for (int i = 0; i < 400; ++i) {
+        float x = -8000.0f + i * 40.0f;
+        float z = 3000.0f - i * 23.0f;
+        const std::string& name = table.names[generator.getBiomeId(x, z)];
+        seen[name]++;
+        if (name == "alpine") {
+            EXPECT_THROW(generator.getBiome(x, z), std::out_of_range);
+        } else {
+            EXPECT_EQ(generator.getBiome(x, z), name == "desert" ? BiomeType::DESERT : BiomeType::TUNDRA);
+        }
+    }
+    EXPECT_EQ(seen.size(), 3u);
+}
+
+
+TEST_F(BiomeTest, SampleGridMatchesPointwise) {
+    std::vector<float> xs, zs;
+    for (int i = 0; i < 17; ++i) xs.push_back(-300.0f + i * 37.5f);
+    for (int j = 0; j < 13; ++j) zs.push_back(1200.0f + j * 41.0f);
+    
+    std::vector<BiomeSample> grid(xs.size() * zs.size());
+    biomeGen->sampleGrid(xs, zs, *heightNoise, grid);
+    
+    for (size_t j = 0; j < zs.size(); ++j) {
+        for (size_t i = 0; i < xs.size(); ++i) {
+            const BiomeSample& s = grid[j * xs.size() + i];
+            BiomeSample point = biomeGen->sample(xs[i], zs[j], *heightNoise);
+            EXPECT_EQ(s.height, point.height);
+            EXPECT_EQ(s.gradient, point.gradient);
+            EXPECT_EQ(s.color, point.color);
+            
+            // Same values as the separate height and color queries
+            EXPECT_FLOAT_EQ(s.height, biomeGen->generateHeight(xs[i], zs[j], *heightNoise));
+            glm::vec3 color = biomeGen->getColor(xs[i], zs[j], s.height, *heightNoise);
+            EXPECT_NEAR(s.color.r, color.r, 1e-5f);
+            EXPECT_NEAR(s.color.g, color.g, 1e-5f);
+            EXPECT_NEAR(s.color.b, color.b, 1e-5f);
+        }
+    }
+    
+    std::vector<BiomeSample> wrongSize(3);
+    EXPECT_THROW(biomeGen->sampleGrid(xs, zs, *heightNoise, wrongSize), std::invalid_argument);
+}
+
+TEST_F(BiomeTest, SampleGradientMatchesFiniteDifference) {
+    // Away from blend zones the weights are constant, so the analytic
+    // gradient should match central differences of generateHeight()
+    const float h = 0.01f;
+    int checked = 0;
+    for (int i = 0; i < 400 && checked < 50; ++i) {
+        float x = -5000.0f + i * 61.0f;
+        float z = 2000.0f - i * 47.0f;
+        bool interior = true;
+        for (glm::vec2 offset : {glm::vec2(0.0f), glm::vec2(h, 0.0f), glm::vec2(-h, 0.0f), glm::vec2(0.0f, h), glm::vec2(0.0f, -h)}) {
+            interior = interior && biomeGen->getBiomeWeights(x + offset.x, z + offset.y).count == 1;
+        }
+        if (!interior) continue;
+        
+        BiomeSample s = biomeGen->sample(x, z, *heightNoise);
+        float dx = (biomeGen->generateHeight(x + h, z, *heightNoise) - biomeGen->generateHeight(x - h, z, *heightNoise)) / (2 * h);
+        float dz = (biomeGen->generateHeight(x, z + h, *heightNoise) - biomeGen->generateHeight(x, z - h, *heightNoise)) / (2 * h);
+        EXPECT_NEAR(s.gradient.x, dx, 0.02f + 0.02f * std::abs(dx));
+        EXPECT_NEAR(s.gradient.y, dz, 0.02f + 0.02f * std::abs(dz));
+        ++checked;
+    }
+    EXPECT_GT(checked, 10);
 }
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <set>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "ChunkQuadtree.h"
+
+namespace {
+
+// What ChunkQuadtree reads from a TerrainChunk
+struct FakeChunk {
+    glm::ivec2 coord;
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    int lod = 0;
+    
+    glm::vec3 getBoundsMin() const { return boundsMin; }
+    glm::vec3 getBoundsMax() const { return boundsMax; }
+    int getLOD() const { return lod; }
+};
+
+using Tree = ChunkQuadtree<std::unique_ptr<FakeChunk>>;
+
+const float CHUNK_SIZE = 64.0f;
+
+std::unique_ptr<FakeChunk> makeChunk(glm::ivec2 coord) {
+    auto chunk = std::make_unique<FakeChunk>();
+    chunk->coord = coord;
+    float base = 20.0f * std::sin(coord.x * 0.3f) * std::cos(coord.y * 0.2f);
+    chunk->boundsMin = glm::vec3(coord.x * CHUNK_SIZE, base - 15.0f, coord.y * CHUNK_SIZE);
+    chunk->boundsMax = glm::vec3((coord.x + 1) * CHUNK_SIZE, base + 15.0f, (coord.y + 1) * CHUNK_SIZE);
+    return chunk;
+}
+
+// Every chunk in the square window of the given radius around center
+void fillWindow(Tree& tree, glm::ivec2 center, int radius) {
+    std::vector<glm::ivec2> missing;
+    tree.forEachMissing(center - glm::ivec2(radius), center + glm::ivec2(radius), [&](glm::ivec2 coord) { missing.push_back(coord); });
+    for (glm::ivec2 coord : missing) {
+        tree.insert(coord, makeChunk(coord));
+    }
+}
+
+// LOD bands 256 units wide around pos, by chunk center distance
+int lodAt(glm::ivec2 coord, glm::vec2 pos) {
+    glm::vec2 center((coord.x + 0.5f) * CHUNK_SIZE, (coord.y + 0.5f) * CHUNK_SIZE);
+    return std::min(static_cast<int>(glm::length(center - pos) / 256.0f), 4);
+}
+
+} // namespace
+
+TEST(ChunkQuadtreeTest, InsertFindExtract) {
+    Tree tree;
+    EXPECT_EQ(tree.find(glm::ivec2(0, 0)), nullptr);
+    
+    // Either side of the block boundaries at 0 and -1
+    for (glm::ivec2 coord : {glm::ivec2(0, 0), glm::ivec2(-1, -1), glm::ivec2(-33, 40), glm::ivec2(31, -32)}) {
+        tree.insert(coord, makeChunk(coord));
+    }
+    EXPECT_EQ(tree.size(), 4u);
+    EXPECT_EQ(tree.getBlockCount(), 4u);
+    ASSERT_NE(tree.find(glm::ivec2(-33, 40)), nullptr);
+    EXPECT_EQ((*tree.find(glm::ivec2(-33, 40)))->coord, glm::ivec2(-33, 40));
+    EXPECT_EQ(tree.find(glm::ivec2(-32, 40)), nullptr);
+    
+    std::unique_ptr<FakeChunk> chunk = tree.extract(glm::ivec2(-1, -1));
+    ASSERT_NE(chunk, nullptr);
+    EXPECT_EQ(chunk->coord, glm::ivec2(-1, -1));
+    EXPECT_EQ(tree.extract(glm::ivec2(-1, -1)), nullptr);
+    EXPECT_EQ(tree.size(), 3u);
+    EXPECT_EQ(tree.getBlockCount(), 3u);
+    
+    int visited = 0;
+    tree.forEach([&](glm::ivec2 coord, const std::unique_ptr<FakeChunk>& chunk) {
+        EXPECT_EQ(chunk->coord, coord);
+        visited++;
+    });
+    EXPECT_EQ(visited, 3);
+}
+
+TEST(ChunkQuadtreeTest, SlidingWindow) {
+    Tree tree;
+    fillWindow(tree, glm::ivec2(0, 0), 32);
+    EXPECT_EQ(tree.size(), 65u * 65u);
+    
+    // One chunk diagonally: a row and a column leave, a row and a column arrive
+    glm::ivec2 center(1, -1);
+    std::set<std::pair<int, int>> removed;
+    tree.removeOutside(center - glm::ivec2(32), center + glm::ivec2(32), [&](glm::ivec2 coord, std::unique_ptr<FakeChunk>&& chunk) {
+        EXPECT_EQ(chunk->coord, coord);
+        removed.insert({coord.x, coord.y});
+    });
+    EXPECT_EQ(removed.size(), 65u + 64u);
+    for (auto [x, y] : removed) {
+        EXPECT_TRUE(x == -32 || y == 32);
+    }
+    
+    std::vector<glm::ivec2> missing;
+    tree.forEachMissing(center - glm::ivec2(32), center + glm::ivec2(32), [&](glm::ivec2 coord) { missing.push_back(coord); });
+    EXPECT_EQ(missing.size(), 65u + 64u);
+    for (glm::ivec2 coord : missing) {
+        EXPECT_TRUE(coord.x == 33 || coord.y == -33);
+    }
+    
+    // Far away, everything goes and the blocks with it
+    tree.removeOutside(glm::ivec2(1000), glm::ivec2(1010), [](glm::ivec2, std::unique_ptr<FakeChunk>&&) {});
+    EXPECT_EQ(tree.size(), 0u);
+    EXPECT_EQ(tree.getBlockCount(), 0u);
+}
+
+TEST(ChunkQuadtreeTest, CullMatchesFlatTest) {
+    // viewDistance 128: 257 x 257 chunks
+    Tree tree;
+    fillWindow(tree, glm::ivec2(0, 0), 128);
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1280.0f / 720.0f, 0.1f, 50000.0f);
+    
+    for (float yaw : {0.0f, 45.0f, 200.0f}) {
+        glm::vec3 eye(32.0f, 60.0f, 32.0f);
+        glm::vec3 forward(std::cos(glm::radians(yaw)), -0.15f, std::sin(glm::radians(yaw)));
+        Frustum frustum = Frustum::fromMatrix(projection * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+        
+        std::vector<FakeChunk*> visible;
+        std::size_t tested = tree.cull(frustum, visible);
+        std::set<FakeChunk*> found(visible.begin(), visible.end());
+        EXPECT_EQ(found.size(), visible.size());
+        
+        std::set<FakeChunk*> expected;
+        tree.forEach([&](glm::ivec2, const std::unique_ptr<FakeChunk>& chunk) {
+            if (frustum.intersects(chunk->boundsMin, chunk->boundsMax)) {
+                expected.insert(chunk.get());
+            }
+        });
+        EXPECT_EQ(found, expected);
+        
+        EXPECT_LT(tested, tree.size() / 4);
+    }
+}
+
+TEST(ChunkQuadtreeTest, UpdateLodsSkipsSettledSubtrees) {
+    Tree tree;
+    fillWindow(tree, glm::ivec2(0, 0), 32);
+    
+    // Chunk centers span the rectangle, so the nearest and furthest points
+    // of it bound every chunk's distance
+    glm::vec2 pos(10.0f, 20.0f);
+    auto bandOf = [&](glm::ivec2 low, glm::ivec2 high) {
+        glm::vec2 centerMin((low.x + 0.5f) * CHUNK_SIZE, (low.y + 0.5f) * CHUNK_SIZE);
+        glm::vec2 centerMax((high.x + 0.5f) * CHUNK_SIZE, (high.y + 0.5f) * CHUNK_SIZE);
+        glm::vec2 nearest(std::clamp(pos.x, centerMin.x, centerMax.x), std::clamp(pos.y, centerMin.y, centerMax.y));
+        glm::vec2 furthest(std::abs(pos.x - centerMin.x) > std::abs(pos.x - centerMax.x) ? centerMin.x : centerMax.x,
+                           std::abs(pos.y - centerMin.y) > std::abs(pos.y - centerMax.y) ? centerMin.y : centerMax.y);
+        int lod = std::min(static_cast<int>(glm::length(nearest - pos) / 256.0f), 4);
+        return lod == std::min(static_cast<int>(glm::length(furthest - pos) / 256.0f), 4) ? lod : -1;
+    };
+    int changed = 0;
+    auto update = [&](glm::ivec2 coord, std::unique_ptr<FakeChunk>& chunk) {
+        int lod = lodAt(coord, pos);
+        if (chunk->lod != lod) {
+            chunk->lod = lod;
+            changed++;
+        }
+    };
+    
+    tree.updateLods(bandOf, update);
+    EXPECT_GT(changed, 0);
+    tree.forEach([&](glm::ivec2 coord, const std::unique_ptr<FakeChunk>& chunk) { EXPECT_EQ(chunk->lod, lodAt(coord, pos)); });
+    
+    // Nothing moved: only the nodes straddling a band boundary are visited
+    changed = 0;
+    std::size_t settled = tree.updateLods(bandOf, update);
+    EXPECT_EQ(changed, 0);
+    EXPECT_LT(settled, tree.size() / 2);
+    
+    // A small move still fixes every chunk that changed band
+    pos += glm::vec2(40.0f, -25.0f);
+    tree.updateLods(bandOf, update);
+    EXPECT_GT(changed, 0);
+    tree.forEach([&](glm::ivec2 coord, const std::unique_ptr<FakeChunk>& chunk) { EXPECT_EQ(chunk->lod, lodAt(coord, pos)); });
+}
\ No newline at end of file
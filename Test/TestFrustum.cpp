@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Frustum.h"
+
+namespace {
+
+// The main window's projection: 60 degree vertical FOV at 1280 x 720
+glm::mat4 cameraProjection() {
+    return glm::perspective(glm::radians(60.0f), 1280.0f / 720.0f, 0.1f, 50000.0f);
+}
+
+} // namespace
+
+TEST(FrustumTest, PlanesOfAPerspective) {
+    // Looking down -z from the origin
+    Frustum frustum = Frustum::fromMatrix(cameraProjection());
+    EXPECT_TRUE(frustum.intersects(glm::vec3(-1.0f, -1.0f, -11.0f), glm::vec3(1.0f, 1.0f, -9.0f)));
+    EXPECT_FALSE(frustum.intersects(glm::vec3(-1.0f, -1.0f, 9.0f), glm::vec3(1.0f, 1.0f, 11.0f)));
+    EXPECT_FALSE(frustum.intersects(glm::vec3(-1.0f, -1.0f, -60000.0f), glm::vec3(1.0f, 1.0f, -55000.0f)));
+    
+    // Off to the side, and a box straddling that side plane
+    EXPECT_FALSE(frustum.intersects(glm::vec3(100.0f, -1.0f, -11.0f), glm::vec3(102.0f, 1.0f, -9.0f)));
+    EXPECT_TRUE(frustum.intersects(glm::vec3(-100.0f, -1.0f, -11.0f), glm::vec3(100.0f, 1.0f, -9.0f)));
+    
+    // Normalized planes give signed distances: the near plane is 0.1 ahead
+    const glm::vec4& nearPlane = frustum.planes[4];
+    EXPECT_NEAR(glm::dot(nearPlane, glm::vec4(0.0f, 0.0f, -1.1f, 1.0f)), 1.0f, 1e-4f);
+}
+
+TEST(FrustumTest, BatchMatchesScalar) {
+    // 1003 boxes so the scalar tail runs too
+    unsigned int state = 2024;
+    auto random = [&state](float low, float high) {
+        state = state * 1664525u + 1013904223u;
+        return low + (high - low) * static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+    };
+    PackedBounds bounds;
+    std::vector<glm::vec3> mins, maxs;
+    for (int i = 0; i < 1003; ++i) {
+        glm::vec3 boundsMin(random(-500.0f, 500.0f), random(-100.0f, 100.0f), random(-500.0f, 500.0f));
+        glm::vec3 boundsMax = boundsMin + glm::vec3(random(0.0f, 64.0f), random(0.0f, 200.0f), random(0.0f, 64.0f));
+        EXPECT_EQ(bounds.add(boundsMin, boundsMax), static_cast<std::size_t>(i));
+        mins.push_back(boundsMin);
+        maxs.push_back(boundsMax);
+    }
+    
+    for (int view = 0; view < 16; ++view) {
+        glm::vec3 eye(random(-200.0f, 200.0f), random(0.0f, 150.0f), random(-200.0f, 200.0f));
+        glm::vec3 target(random(-500.0f, 500.0f), random(-100.0f, 100.0f), random(-500.0f, 500.0f));
+        Frustum frustum = Frustum::fromMatrix(cameraProjection() * glm::lookAt(eye, target, glm::vec3(0.0f, 1.0f, 0.0f)));
+        
+        std::vector<std::uint32_t> expected;
+        for (std::uint32_t i = 0; i < mins.size(); ++i) {
+            if (frustum.intersects(mins[i], maxs[i])) {
+                expected.push_back(i);
+            }
+        }
+        std::vector<std::uint32_t> visible;
+        bounds.cull(frustum, visible);
+        EXPECT_EQ(visible, expected);
+    }
+    
+    bounds.clear();
+    std::vector<std::uint32_t> visible(3);
+    bounds.cull(Frustum::fromMatrix(cameraProjection()), visible);
+    EXPECT_TRUE(visible.empty());
+}
+
+TEST(FrustumTest, ChunkGridRejection) {
+    // The default view: 65 x 65 chunks of 64 units around a camera flying
+    // level a little above rolling terrain
+    const int viewDistance = 32;
+    const float chunkSize = 64.0f;
+    PackedBounds bounds;
+    for (int z = -viewDistance; z <= viewDistance; ++z) {
+        for (int x = -viewDistance; x <= viewDistance; ++x) {
+            float base = 20.0f * std::sin(x * 0.3f) * std::cos(z * 0.2f);
+            bounds.add(glm::vec3(x * chunkSize, base - 15.0f, z * chunkSize),
+                       glm::vec3((x + 1) * chunkSize, base + 15.0f, (z + 1) * chunkSize));
+        }
+    }
+    
+    // Headings along an axis and a diagonal, pitched slightly down
+    for (float yaw : {0.0f, 45.0f, 120.0f}) {
+        glm::vec3 eye(32.0f, 60.0f, 32.0f);
+        glm::vec3 forward(std::cos(glm::radians(yaw)), -0.15f, std::sin(glm::radians(yaw)));
+        Frustum frustum = Frustum::fromMatrix(cameraProjection() * glm::lookAt(eye, eye + forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+        std::vector<std::uint32_t> visible;
+        bounds.cull(frustum, visible);
+        
+        float rejected = 1.0f - static_cast<float>(visible.size()) / bounds.size();
+        EXPECT_GT(rejected, 0.6f);
+        EXPECT_LT(rejected, 0.8f);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include "GridIndices.h"
+
+namespace {
+
+using Triangle = std::array<unsigned int, 3>;
+
+// Rotate so the smallest index comes first; keeps the winding
+Triangle canonical(Triangle t) {
+    std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+    return t;
+}
+
+// Expand a restart-separated GL_TRIANGLE_STRIP the way GL does
+std::vector<Triangle> expandStrips(const std::vector<unsigned int>& strips, unsigned int restartIndex) {
+    std::vector<Triangle> triangles;
+    size_t start = 0;
+    for (size_t i = 0; i <= strips.size(); ++i) {
+        if (i < strips.size() && strips[i] != restartIndex) continue;
+        for (size_t k = start; k + 2 < i; ++k) {
+            bool odd = (k - start) % 2 == 1;
+            triangles.push_back(canonical(odd ? Triangle{strips[k + 1], strips[k], strips[k + 2]}
+                                              : Triangle{strips[k], strips[k + 1], strips[k + 2]}));
+        }
+        start = i + 1;
+    }
+    return triangles;
+}
+
+} // namespace
+
+TEST(GridIndicesTest, TrianglesCoverGrid) {
+    for (int resolution : {2, 8, 16, 32, 65}) {
+        std::vector<unsigned int> indices = buildGridTriangles(resolution);
+        ASSERT_EQ(indices.size(), static_cast<size_t>((resolution - 1) * (resolution - 1) * 6));
+        
+        // Every triangle is in range, faces +Y, and together they cover the
+        // grid's area exactly
+        int twiceArea = 0;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            int ax = indices[i] % resolution, az = indices[i] / resolution;
+            int bx = indices[i + 1] % resolution, bz = indices[i + 1] / resolution;
+            int cx = indices[i + 2] % resolution, cz = indices[i + 2] / resolution;
+            ASSERT_LT(indices[i], static_cast<unsigned int>(resolution * resolution));
+            ASSERT_LT(indices[i + 1], static_cast<unsigned int>(resolution * resolution));
+            ASSERT_LT(indices[i + 2], static_cast<unsigned int>(resolution * resolution));
+            
+            // Y component of (b - a) x (c - a) in (x, y, z) space
+            int normalY = (bz - az) * (cx - ax) - (bx - ax) * (cz - az);
+            ASSERT_GT(normalY, 0);
+            twiceArea += normalY;
+        }
+        EXPECT_EQ(twiceArea, 2 * (resolution - 1) * (resolution - 1));
+    }
+}
+
+TEST(GridIndicesTest, StripsMatchTriangles) {
+    const unsigned int restart = 0xFFFF;
+    for (int resolution : {2, 8, 33, 65}) {
+        std::vector<unsigned int> list = buildGridTriangles(resolution);
+        std::vector<Triangle> expected;
+        for (size_t i = 0; i < list.size(); i += 3) {
+            expected.push_back(canonical({list[i], list[i + 1], list[i + 2]}));
+        }
+        
+        std::vector<unsigned int> strips = buildGridStrips(resolution, restart);
+        std::vector<Triangle> actual = expandStrips(strips, restart);
+        std::sort(expected.begin(), expected.end());
+        std::sort(actual.begin(), actual.end());
+        EXPECT_EQ(actual, expected);
+        
+        // One restart between rows; about a third of the list's indices
+        EXPECT_EQ(strips.size(), static_cast<size_t>((resolution - 1) * (2 * resolution + 1) - 1));
+        EXPECT_EQ(std::count(strips.begin(), strips.end(), restart), resolution - 2);
+    }
+}
+
+TEST(GridIndicesTest, StitchedEdgesSkipOddVertices) {
+    for (int resolution : {3, 9, 17, 65}) {
+        const int last = resolution - 1;
+        for (unsigned int edges = 0; edges < EDGE_MASK_COUNT; ++edges) {
+            std::vector<unsigned int> indices = buildGridTriangles(resolution, edges);
+            
+            // Still a +Y facing tiling of the whole grid, but no triangle
+            // touches a vertex the coarser neighbour does not have
+            int twiceArea = 0;
+            for (size_t i = 0; i < indices.size(); i += 3) {
+                int xs[3], zs[3];
+                for (int k = 0; k < 3; ++k) {
+                    xs[k] = indices[i + k] % resolution;
+                    zs[k] = indices[i + k] / resolution;
+                    bool oddAlongX = xs[k] % 2 == 1;
+                    bool oddAlongZ = zs[k] % 2 == 1;
+                    ASSERT_FALSE((edges & EDGE_NORTH) && zs[k] == 0 && oddAlongX);
+                    ASSERT_FALSE((edges & EDGE_SOUTH) && zs[k] == last && oddAlongX);
+                    ASSERT_FALSE((edges & EDGE_WEST) && xs[k] == 0 && oddAlongZ);
+                    ASSERT_FALSE((edges & EDGE_EAST) && xs[k] == last && oddAlongZ);
+                }
+                int normalY = (zs[1] - zs[0]) * (xs[2] - xs[0]) - (xs[1] - xs[0]) * (zs[2] - zs[0]);
+                ASSERT_GT(normalY, 0);
+                twiceArea += normalY;
+            }
+            EXPECT_EQ(twiceArea, 2 * last * last);
+        }
+    }
+}
+
+TEST(GridIndicesTest, StitchedStripsMatchTriangles) {
+    const unsigned int restart = 0xFFFF;
+    for (int resolution : {3, 17, 65}) {
+        for (unsigned int edges = 0; edges < EDGE_MASK_COUNT; ++edges) {
+            std::vector<unsigned int> list = buildGridTriangles(resolution, edges);
+            std::vector<Triangle> expected;
+            for (size_t i = 0; i < list.size(); i += 3) {
+                expected.push_back(canonical({list[i], list[i + 1], list[i + 2]}));
+            }
+            
+            // Collapsed strip triangles are skipped by GL
+            std::vector<Triangle> actual;
+            for (const Triangle& t : expandStrips(buildGridStrips(resolution, restart, edges), restart)) {
+                if (t[0] != t[1] && t[1] != t[2] && t[0] != t[2]) {
+                    actual.push_back(t);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+            std::sort(actual.begin(), actual.end());
+            EXPECT_EQ(actual, expected);
+        }
+    }
+}
+
+TEST(GridIndicesTest, UnstitchableGridIgnoresEdges) {
+    EXPECT_FALSE(canStitchEdges(2));
+    EXPECT_FALSE(canStitchEdges(8));
+    EXPECT_TRUE(canStitchEdges(9));
+    EXPECT_EQ(buildGridTriangles(2, EDGE_NORTH | EDGE_WEST), buildGridTriangles(2));
+    EXPECT_EQ(buildGridStrips(8, 0xFFFF, EDGE_EAST), buildGridStrips(8, 0xFFFF));
+}
+
+TEST(GridIndicesTest, ParseEncoding) {
+    EXPECT_EQ(parseIndexEncoding("strips"), IndexEncoding::STRIPS);
+    EXPECT_EQ(parseIndexEncoding("triangles"), IndexEncoding::TRIANGLES);
+    EXPECT_STREQ(indexEncodingName(IndexEncoding::STRIPS), "strips");
+    EXPECT_THROW(parseIndexEncoding("fans"), std::runtime_error);
+}
\ No newline at end of file
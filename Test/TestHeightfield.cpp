@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "Heightfield.h"
+
+namespace {
+
+float surface(float x, float z) {
+    return 12.0f * std::sin(x * 0.05f) * std::cos(z * 0.03f) + 0.2f * x;
+}
+
+// Heights over xs x zs, row-major
+std::vector<float> sampleSurface(const std::vector<float>& xs, const std::vector<float>& zs) {
+    std::vector<float> heights;
+    for (float z : zs) {
+        for (float x : xs) {
+            heights.push_back(surface(x, z));
+        }
+    }
+    return heights;
+}
+
+} // namespace
+
+TEST(HeightfieldTest, PlaneNormalsExact) {
+    std::vector<float> xs, zs;
+    for (int i = 0; i < 11; ++i) xs.push_back(i * 2.0f);
+    for (int i = 0; i < 7; ++i) zs.push_back(i * 4.0f);
+    std::vector<float> heights;
+    for (float z : zs) {
+        for (float x : xs) {
+            heights.push_back(0.5f * x - 0.25f * z + 3.0f);
+        }
+    }
+    
+    std::vector<glm::vec3> normals(9 * 5);
+    heightfieldNormals(heights, xs, zs, normals);
+    glm::vec3 expected = glm::normalize(glm::vec3(-0.5f, 1.0f, 0.25f));
+    for (const glm::vec3& n : normals) {
+        EXPECT_NEAR(n.x, expected.x, 1e-6f);
+        EXPECT_NEAR(n.y, expected.y, 1e-6f);
+        EXPECT_NEAR(n.z, expected.z, 1e-6f);
+    }
+    
+    std::vector<glm::vec3> wrongSize(3);
+    EXPECT_THROW(heightfieldNormals(heights, xs, zs, wrongSize), std::invalid_argument);
+}
+
+TEST(HeightfieldTest, SharedNeighbourhoodGivesIdenticalNormals) {
+    // Two overlapping windows, as two neighbouring chunks with aprons see
+    // the same edge vertex. The vertex lands in a different lane or in the
+    // scalar tail, but its normal must match bit for bit.
+    std::vector<float> axis;
+    for (int i = 0; i < 40; ++i) axis.push_back(100.0f + i * 1.0f);
+    std::vector<float> zs(axis.begin(), axis.begin() + 6);
+    
+    std::vector<float> xsA(axis.begin(), axis.begin() + 23);
+    std::vector<float> xsB(axis.begin() + 19, axis.end());
+    std::vector<glm::vec3> normalsA((xsA.size() - 2) * 4), normalsB((xsB.size() - 2) * 4);
+    heightfieldNormals(sampleSurface(xsA, zs), xsA, zs, normalsA);
+    heightfieldNormals(sampleSurface(xsB, zs), xsB, zs, normalsB);
+    
+    // axis[20] and axis[21] are interior to both windows
+    for (int z = 0; z < 4; ++z) {
+        for (int i = 20; i <= 21; ++i) {
+            glm::vec3 a = normalsA[z * (xsA.size() - 2) + (i - 1)];
+            glm::vec3 b = normalsB[z * (xsB.size() - 2) + (i - 20)];
+            EXPECT_EQ(a, b);
+        }
+    }
+}
+
+TEST(HeightfieldTest, MatchesAnalyticSlope) {
+    std::vector<float> xs, zs;
+    for (int i = 0; i < 67; ++i) xs.push_back(-1.0f + i * 1.0f);
+    for (int i = 0; i < 67; ++i) zs.push_back(-1.0f + i * 1.0f);
+    std::vector<glm::vec3> normals(65 * 65);
+    heightfieldNormals(sampleSurface(xs, zs), xs, zs, normals);
+    
+    for (int z = 0; z < 65; ++z) {
+        for (int x = 0; x < 65; ++x) {
+            float wx = xs[x + 1], wz = zs[z + 1];
+            float dx = 12.0f * 0.05f * std::cos(wx * 0.05f) * std::cos(wz * 0.03f) + 0.2f;
+            float dz = -12.0f * 0.03f * std::sin(wx * 0.05f) * std::sin(wz * 0.03f);
+            glm::vec3 expected = glm::normalize(glm::vec3(-dx, 1.0f, -dz));
+            EXPECT_GT(glm::dot(normals[z * 65 + x], expected), 0.9999f);
+        }
+    }
+}
+
+TEST(HeightfieldTest, ParseNormalSource) {
+    EXPECT_EQ(parseNormalSource("heightfield"), NormalSource::HEIGHTFIELD);
+    EXPECT_EQ(parseNormalSource("analytic"), NormalSource::ANALYTIC);
+    EXPECT_STREQ(normalSourceName(NormalSource::HEIGHTFIELD), "heightfield");
+    EXPECT_THROW(parseNormalSource("sobel"), std::runtime_error);
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <vector>
+#include "HorizonCuller.h"
+
+namespace {
+
+// What HorizonCuller::cull() reads from a TerrainChunk
+struct FakeChunk {
+    glm::ivec2 coord;
+    glm::vec3 boundsMin;
+    glm::vec3 boundsMax;
+    
+    glm::vec3 getBoundsMin() const { return boundsMin; }
+    glm::vec3 getBoundsMax() const { return boundsMax; }
+};
+
+const float CHUNK_SIZE = 64.0f;
+const int CHUNK_CELLS = 16; // Grid cells per chunk side, 4 units each
+
+// Ridges and valleys on the mountain biome's scale
+float mountainHeight(float x, float z) {
+    return 60.0f * std::sin(x * 0.011f) * std::cos(z * 0.007f) + 45.0f * std::abs(std::sin(x * 0.004f + z * 0.009f)) +
+           8.0f * std::sin(x * 0.05f) * std::sin(z * 0.043f);
+}
+
+// The surface between grid vertices, interpolated like the mesh; never
+// outside its corners' heights
+float surfaceHeight(float x, float z) {
+    const float step = CHUNK_SIZE / CHUNK_CELLS;
+    float gx = std::floor(x / step);
+    float gz = std::floor(z / step);
+    float fx = x / step - gx;
+    float fz = z / step - gz;
+    float h00 = mountainHeight(gx * step, gz * step);
+    float h10 = mountainHeight((gx + 1) * step, gz * step);
+    float h01 = mountainHeight(gx * step, (gz + 1) * step);
+    float h11 = mountainHeight((gx + 1) * step, (gz + 1) * step);
+    return (h00 * (1 - fx) + h10 * fx) * (1 - fz) + (h01 * (1 - fx) + h11 * fx) * fz;
+}
+
+std::vector<FakeChunk> makeChunks(int viewDistance) {
+    std::vector<FakeChunk> chunks;
+    for (int z = -viewDistance; z <= viewDistance; ++z) {
+        for (int x = -viewDistance; x <= viewDistance; ++x) {
+            FakeChunk chunk;
+            chunk.coord = glm::ivec2(x, z);
+            float low = mountainHeight(x * CHUNK_SIZE, z * CHUNK_SIZE);
+            float high = low;
+            for (int j = 0; j <= CHUNK_CELLS; ++j) {
+                for (int i = 0; i <= CHUNK_CELLS; ++i) {
+                    float h = mountainHeight(x * CHUNK_SIZE + i * CHUNK_SIZE / CHUNK_CELLS, z * CHUNK_SIZE + j * CHUNK_SIZE / CHUNK_CELLS);
+                    low = std::min(low, h);
+                    high = std::max(high, h);
+                }
+            }
+            chunk.boundsMin = glm::vec3(x * CHUNK_SIZE, low, z * CHUNK_SIZE);
+            chunk.boundsMax = glm::vec3((x + 1) * CHUNK_SIZE, high, (z + 1) * CHUNK_SIZE);
+            chunks.push_back(chunk);
+        }
+    }
+    return chunks;
+}
+
+// Marches from eye towards target; true if the ground is above the line
+// anywhere before the last unit
+bool lineBlocked(const glm::vec3& eye, const glm::vec3& target) {
+    glm::vec3 delta = target - eye;
+    float distance = glm::length(glm::vec2(delta.x, delta.z));
+    for (float d = 0.25f; d < distance - 1.0f; d += 0.25f) {
+        glm::vec3 point = eye + delta * (d / distance);
+        if (surfaceHeight(point.x, point.z) > point.y) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(HorizonCullerTest, RidgeHidesWhatIsBehindIt) {
+    // Flat ground with the eye 10 above it, and a wall 50 high along the
+    // ring of chunks two out
+    HorizonCuller culler;
+    glm::vec3 eye(32.0f, 10.0f, 32.0f);
+    culler.begin(eye);
+    for (int z = -2; z <= 2; ++z) {
+        for (int x = -2; x <= 2; ++x) {
+            if (std::max(std::abs(x), std::abs(z)) == 2) {
+                culler.addOccluder(glm::vec2(x, z) * CHUNK_SIZE, glm::vec2(x + 1, z + 1) * CHUNK_SIZE, 50.0f);
+            }
+        }
+    }
+    
+    // Nothing hides until the ring is committed
+    glm::vec2 behind(6 * CHUNK_SIZE, 0.0f);
+    EXPECT_FALSE(culler.isHidden(behind, behind + glm::vec2(CHUNK_SIZE), 20.0f));
+    culler.commit();
+    EXPECT_TRUE(culler.isHidden(behind, behind + glm::vec2(CHUNK_SIZE), 20.0f));
+    EXPECT_TRUE(culler.isHidden(glm::vec2(-6 * CHUNK_SIZE, 0.0f), glm::vec2(-5 * CHUNK_SIZE, CHUNK_SIZE), 20.0f));
+    
+    // Peaks high enough to show over the wall from the eye
+    EXPECT_FALSE(culler.isHidden(behind, behind + glm::vec2(CHUNK_SIZE), 500.0f));
+    EXPECT_FALSE(culler.isHidden(glm::vec2(40 * CHUNK_SIZE, 0.0f), glm::vec2(41 * CHUNK_SIZE, CHUNK_SIZE), 1000.0f));
+    
+    // The eye's own footprint, and an eye above the wall
+    EXPECT_FALSE(culler.isHidden(glm::vec2(0.0f), glm::vec2(CHUNK_SIZE), -100.0f));
+    culler.begin(glm::vec3(32.0f, 200.0f, 32.0f));
+    culler.addOccluder(glm::vec2(2 * CHUNK_SIZE, 0.0f), glm::vec2(3 * CHUNK_SIZE, CHUNK_SIZE), 50.0f);
+    culler.commit();
+    EXPECT_FALSE(culler.isHidden(behind, behind + glm::vec2(CHUNK_SIZE), 20.0f));
+}
+
+TEST(HorizonCullerTest, CullIsConservativeInMountains) {
+    std::vector<FakeChunk> chunks = makeChunks(24);
+    HorizonCuller culler;
+    
+    // The camera flies a fixed height above the ground
+    for (glm::vec2 position : {glm::vec2(10.0f, 20.0f), glm::vec2(-300.0f, 140.0f), glm::vec2(420.0f, -380.0f)}) {
+        glm::vec3 eye(position.x, surfaceHeight(position.x, position.y) + 10.0f, position.y);
+        std::vector<FakeChunk*> kept;
+        for (FakeChunk& chunk : chunks) {
+            kept.push_back(&chunk);
+        }
+        std::size_t dropped = culler.cull(eye, CHUNK_SIZE, kept);
+        EXPECT_EQ(kept.size() + dropped, chunks.size());
+        
+        // Front to back by ring
+        glm::ivec2 eyeChunk(static_cast<int>(std::floor(eye.x / CHUNK_SIZE)), static_cast<int>(std::floor(eye.z / CHUNK_SIZE)));
+        auto ringOf = [&](const FakeChunk* chunk) {
+            return std::max(std::abs(chunk->coord.x - eyeChunk.x), std::abs(chunk->coord.y - eyeChunk.y));
+        };
+        EXPECT_TRUE(std::is_sorted(kept.begin(), kept.end(), [&](const FakeChunk* a, const FakeChunk* b) { return ringOf(a) < ringOf(b); }));
+        
+        // Every hidden chunk really is: lines of sight to points across its
+        // surface all go into the ground on the way
+        std::set<const FakeChunk*> visible(kept.begin(), kept.end());
+        for (const FakeChunk& chunk : chunks) {
+            if (visible.count(&chunk) > 0) {
+                continue;
+            }
+            for (int j = 0; j <= CHUNK_CELLS; j += CHUNK_CELLS / 2) {
+                for (int i = 0; i <= CHUNK_CELLS; i += CHUNK_CELLS / 2) {
+                    float x = chunk.boundsMin.x + i * CHUNK_SIZE / CHUNK_CELLS;
+                    float z = chunk.boundsMin.z + j * CHUNK_SIZE / CHUNK_CELLS;
+                    EXPECT_TRUE(lineBlocked(eye, glm::vec3(x, surfaceHeight(x, z), z)))
+                        << "chunk " << chunk.coord.x << ", " << chunk.coord.y << " point " << i << ", " << j;
+                }
+            }
+        }
+        EXPECT_GT(dropped, chunks.size() / 10);
+    }
+}
+
+TEST(HorizonCullerTest, DefaultViewDropsMostChunks) {
+    // viewDistance 32 at the default 2048 bins, 10 units above the ground
+    std::vector<FakeChunk> chunks = makeChunks(32);
+    HorizonCuller culler;
+    glm::vec3 eye(10.0f, surfaceHeight(10.0f, 20.0f) + 10.0f, 20.0f);
+    std::vector<FakeChunk*> kept;
+    for (FakeChunk& chunk : chunks) {
+        kept.push_back(&chunk);
+    }
+    std::size_t dropped = culler.cull(eye, CHUNK_SIZE, kept);
+    EXPECT_EQ(kept.size() + dropped, chunks.size());
+    EXPECT_GT(dropped, chunks.size() / 2);
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+#include "LodMorph.h"
+
+namespace {
+
+// Defaults from config.json
+const std::vector<float> MORPH_DISTANCES = {128.0f, 256.0f, 384.0f, 640.0f, 1024.0f};
+const int MORPH_LEVELS = 6;
+const float MORPH_REGION = 0.5f;
+const float CHUNK_SIZE = 64.0f;
+const int RESOLUTION = 65;
+const int VIEW_DISTANCE = 32;
+
+// Scripted flight: a low pass over the start area, a climb, then a banked
+// turn at altitude, sampled every 10 units of distance
+std::vector<glm::vec3> flightPath() {
+    std::vector<glm::vec3> path;
+    for (int i = 0; i <= 300; ++i) {
+        float t = i / 300.0f;
+        float angle = t * 3.14159265f;
+        float x = 32.0f + 1500.0f * std::sin(angle);
+        float z = 32.0f + 1500.0f * (1.0f - std::cos(angle));
+        float altitude = 50.0f + 350.0f * std::sin(angle * 0.5f);
+        path.push_back(glm::vec3(x, altitude, z));
+    }
+    return path;
+}
+
+} // namespace
+
+TEST(LodMorphTest, ParseMode) {
+    EXPECT_EQ(parseLodMode("discrete"), LodMode::DISCRETE);
+    EXPECT_EQ(parseLodMode("morph"), LodMode::MORPH);
+    EXPECT_STREQ(lodModeName(LodMode::MORPH), "morph");
+    EXPECT_THROW(parseLodMode("geomorph"), std::runtime_error);
+}
+
+TEST(LodMorphTest, SelectLodUsesBands) {
+    const std::vector<float> distances = {128.0f, 256.0f};
+    EXPECT_EQ(selectLod(distances, 3, 0.0f), 0);
+    EXPECT_EQ(selectLod(distances, 3, 127.9f), 0);
+    EXPECT_EQ(selectLod(distances, 3, 128.0f), 1);
+    EXPECT_EQ(selectLod(distances, 3, 5000.0f), 2);
+    
+    // Extra distances never select a level that was not built
+    EXPECT_EQ(selectLod({100.0f, 200.0f, 300.0f}, 2, 250.0f), 1);
+}
+
+TEST(LodMorphTest, MorphFinishesBeforeChunkSwitches) {
+    const float halfDiagonal = CHUNK_SIZE * std::sqrt(0.5f);
+    for (int lod = 0; lod < MORPH_LEVELS; ++lod) {
+        LodMorphRange range = lodMorphRange(MORPH_DISTANCES, MORPH_LEVELS, lod, CHUNK_SIZE, MORPH_REGION);
+        if (lod == MORPH_LEVELS - 1) {
+            EXPECT_FALSE(range.morphs()); // Nothing coarser to morph to
+            continue;
+        }
+        ASSERT_TRUE(range.morphs()) << "LOD " << lod;
+        
+        // Every vertex of a chunk leaving this LOD is fully morphed, and no
+        // vertex of a chunk arriving from the finer LOD has started
+        EXPECT_LE(range.end + halfDiagonal, MORPH_DISTANCES[lod] + 1e-3f);
+        if (lod > 0) {
+            EXPECT_GE(range.start - halfDiagonal, MORPH_DISTANCES[lod - 1] - 1e-3f);
+        }
+    }
+    
+    // A band narrower than a chunk diagonal has no room to morph
+    EXPECT_FALSE(lodMorphRange({128.0f, 200.0f, 300.0f}, 4, 1, CHUNK_SIZE, MORPH_REGION).morphs());
+}
+
+TEST(LodMorphTest, FlightPathTriangleCounts) {
+    // Before morphing, LOD bands had to stay conservative to hide popping
+    const std::vector<float> discreteDistances = {256.0f, 512.0f, 1024.0f, 2048.0f};
+    const int discreteLevels = 4;
+    
+    std::size_t discreteTotal = 0, morphTotal = 0;
+    std::size_t discretePeak = 0, morphPeak = 0;
+    std::vector<glm::vec3> path = flightPath();
+    for (const glm::vec3& position : path) {
+        std::size_t discrete = viewTriangleCount(discreteDistances, discreteLevels, RESOLUTION, CHUNK_SIZE, VIEW_DISTANCE, position);
+        std::size_t morph = viewTriangleCount(MORPH_DISTANCES, MORPH_LEVELS, RESOLUTION, CHUNK_SIZE, VIEW_DISTANCE, position);
+        discreteTotal += discrete;
+        morphTotal += morph;
+        discretePeak = std::max(discretePeak, discrete);
+        morphPeak = std::max(morphPeak, morph);
+    }
+    
+    EXPECT_LT(morphTotal * 4, discreteTotal);
+    EXPECT_LT(morphPeak * 4, discretePeak);
+}
\ No newline at end of file
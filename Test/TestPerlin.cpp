@@ -62,4 +62,143 @@ TEST_F(PerlinTest, ZeroOctaves) {
     // Zero octaves should return 0
     double value = perlin->octaveNoise(1.0, 2.0, 3.0, 0, 0.5);
     EXPECT_DOUBLE_EQ(value, 0.0);
-}
\ No newline at end of file
+}
+
+TEST_F(PerlinTest, Noise2DMatches3DSlice) {
+    // The 2D path is the integer z = layer plane of the 3D noise
+    for (int i = 0; i < 50; ++i) {
+        float x = -20.0f + i * 0.917f;
+        float y = 7.5f - i * 0.613f;
+        int layer = (i % 3) * 50;
+        
+        EXPECT_NEAR(perlin->noise2D(x, y, layer), perlin->noise(x, y, layer), 1e-5);
+        EXPECT_NEAR(perlin->octaveNoise2D(x, y, 4, 0.5f, layer),
+                    perlin->octaveNoise(x, y, layer, 4, 0.5), 1e-5);
+    }
+}
+
+TEST_F(PerlinTest, BatchMatchesScalar) {
+    // Odd length so every SIMD kernel also exercises its scalar tail
+    const int count = 103;
+    std::vector<float> xs(count), ys(count), out(count);
+    for (int i = 0; i < count; ++i) {
+        xs[i] = -37.3f + i * 0.731f;
+        ys[i] = 12.9f - i * 0.419f;
+    }
+    
+    for (NoiseKernel kernel : {NoiseKernel::Scalar, NoiseKernel::SSE42, NoiseKernel::AVX2}) {
+        if (!PerlinNoise::isKernelSupported(kernel)) continue;
+        
+        perlin->octaveNoiseBatch(xs, ys, 6, 0.5f, out, 0, kernel);
+        for (int i = 0; i < count; ++i) {
+            float expected = perlin->octaveNoise2D(xs[i], ys[i], 6, 0.5f);
+            EXPECT_NEAR(out[i], expected, PerlinNoise::BATCH_TOLERANCE)
+                << PerlinNoise::kernelName(kernel) << " sample " << i;
+        }
+    }
+}
+
+TEST_F(PerlinTest, BatchNonZeroLayer) {
+    std::vector<float> xs = {0.25f, 1.5f, 2.75f, 3.125f, 4.0f, -5.5f, 6.25f, -7.75f, 8.5f};
+    std::vector<float> ys = {9.5f, 8.25f, 7.0f, 6.875f, 5.5f, -4.25f, 3.0f, 2.5f, -1.125f};
+    std::vector<float> out(xs.size());
+    
+    perlin->octaveNoiseBatch(xs, ys, 2, 0.4f, out, 100);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        EXPECT_NEAR(out[i], perlin->octaveNoise2D(xs[i], ys[i], 2, 0.4f, 100), PerlinNoise::BATCH_TOLERANCE);
+    }
+}
+
+TEST_F(PerlinTest, BatchSizeMismatch) {
+    std::vector<float> xs(4), ys(3), out(4);
+    EXPECT_THROW(perlin->octaveNoiseBatch(xs, ys, 4, 0.5f, out), std::invalid_argument);
+}
+
+TEST_F(PerlinTest, GradientValueMatchesNoise) {
+    for (int i = 0; i < 50; ++i) {
+        float x = -20.0f + i * 0.917f;
+        float y = 7.5f - i * 0.613f;
+        
+        EXPECT_FLOAT_EQ(perlin->noise2DWithGradient(x, y).value, perlin->noise2D(x, y));
+        EXPECT_FLOAT_EQ(perlin->octaveNoise2DWithGradient(x, y, 6, 0.5f).value,
+                        perlin->octaveNoise2D(x, y, 6, 0.5f));
+    }
+}
+
+TEST_F(PerlinTest, GradientMatchesFiniteDifference) {
+    // Difference the double-precision 3D slice so float rounding in the
+    // reference doesn't swamp the comparison
+    const double h = 1e-6;
+    for (int i = 0; i < 50; ++i) {
+        float x = 3.1f + i * 0.377f;
+        float y = -1.7f + i * 0.291f;
+        int layer = i % 3;
+        
+        NoiseGradient g = perlin->octaveNoise2DWithGradient(x, y, 6, 0.5f, layer);
+        double dx = (perlin->octaveNoise(x + h, y, layer, 6, 0.5) - perlin->octaveNoise(x - h, y, layer, 6, 0.5)) / (2 * h);
+        double dy = (perlin->octaveNoise(x, y + h, layer, 6, 0.5) - perlin->octaveNoise(x, y - h, layer, 6, 0.5)) / (2 * h);
+        
+        EXPECT_NEAR(g.dx, dx, 1e-4);
+        EXPECT_NEAR(g.dy, dy, 1e-4);
+    }
+}
+
+TEST_F(PerlinTest, GridMatchesScalar) {
+    // Irregular axes, including a negative range and repeated cells
+    std::vector<float> xs = {-3.9f, -3.2f, -0.01f, 0.0f, 0.33f, 0.34f, 1.7f, 2.05f, 9.99f};
+    std::vector<float> ys = {-1.25f, 0.5f, 0.6f, 4.0f, 12.75f};
+    std::vector<float> values(xs.size() * ys.size());
+    std::vector<NoiseGradient> gradients(xs.size() * ys.size());
+    
+    perlin->evaluateGrid(xs, ys, 6, 0.5f, values, 3);
+    perlin->evaluateGrid(xs, ys, 6, 0.5f, gradients, 3);
+    for (size_t j = 0; j < ys.size(); ++j) {
+        for (size_t i = 0; i < xs.size(); ++i) {
+            size_t index = j * xs.size() + i;
+            NoiseGradient expected = perlin->octaveNoise2DWithGradient(xs[i], ys[j], 6, 0.5f, 3);
+            EXPECT_FLOAT_EQ(values[index], perlin->octaveNoise2D(xs[i], ys[j], 6, 0.5f, 3));
+            EXPECT_FLOAT_EQ(gradients[index].value, expected.value);
+            EXPECT_FLOAT_EQ(gradients[index].dx, expected.dx);
+            EXPECT_FLOAT_EQ(gradients[index].dy, expected.dy);
+        }
+    }
+}
+
+TEST_F(PerlinTest, GridOriginStep) {
+    const int width = 17;
+    const int height = 11;
+    std::vector<float> out(width * height);
+    
+    perlin->evaluateGrid(-2.5f, 40.0f, 0.15f, width, height, 4, 0.5f, out);
+    for (int j = 0; j < height; ++j) {
+        for (int i = 0; i < width; ++i) {
+            float expected = perlin->octaveNoise2D(-2.5f + i * 0.15f, 40.0f + j * 0.15f, 4, 0.5f);
+            EXPECT_FLOAT_EQ(out[j * width + i], expected);
+        }
+    }
+}
+
+TEST_F(PerlinTest, GridSizeMismatch) {
+    std::vector<float> out(10);
+    EXPECT_THROW(perlin->evaluateGrid(0.0f, 0.0f, 1.0f, 4, 3, 4, 0.5f, out), std::invalid_argument);
+}
+
+TEST_F(PerlinTest, LayersAndCombineMatchOctaveNoise) {
+    const int layers[3] = {0, 100, 7};
+    float values[3];
+    for (int i = 0; i < 30; ++i) {
+        float x = -5.0f + i * 0.377f;
+        float y = 2.0f - i * 0.219f;
+        
+        perlin->noise2DLayers(x, y, layers, values);
+        for (int l = 0; l < 3; ++l) {
+            EXPECT_FLOAT_EQ(values[l], perlin->noise2D(x, y, layers[l]));
+        }
+        
+        float octaves[5];
+        for (int o = 0; o < 5; ++o) {
+            octaves[o] = perlin->noise2D(x * (1 << o), y * (1 << o));
+        }
+        EXPECT_FLOAT_EQ(PerlinNoise::combineOctaves(octaves, 0.6f), perlin->octaveNoise2D(x, y, 5, 0.6f));
+    }
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include "VertexCache.h"
+#include "GridIndices.h"
+
+namespace {
+
+const unsigned int RESTART = 0xFFFF;
+
+using Triangle = std::array<unsigned int, 3>;
+
+// Rotate so the smallest index comes first; keeps the winding
+std::vector<Triangle> sortedTriangles(const std::vector<unsigned int>& list) {
+    std::vector<Triangle> triangles;
+    for (std::size_t i = 0; i + 2 < list.size(); i += 3) {
+        Triangle t = {list[i], list[i + 1], list[i + 2]};
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+} // namespace
+
+TEST(VertexCacheTest, MeasuresKnownOrders) {
+    // One triangle: three misses, nothing reused
+    VertexCacheStats single = measureVertexCache(std::vector<unsigned int>{0, 1, 2}, IndexEncoding::TRIANGLES);
+    EXPECT_EQ(single.triangles, 1u);
+    EXPECT_EQ(single.vertices, 3u);
+    EXPECT_DOUBLE_EQ(single.acmr(), 3.0);
+    EXPECT_DOUBLE_EQ(single.atvr(), 1.0);
+    
+    // A quad's second triangle only adds one vertex
+    VertexCacheStats quad = measureVertexCache(std::vector<unsigned int>{0, 2, 1, 1, 2, 3}, IndexEncoding::TRIANGLES);
+    EXPECT_EQ(quad.misses, 4u);
+    EXPECT_DOUBLE_EQ(quad.acmr(), 2.0);
+    
+    // The same quad as a strip, and collapsed strip triangles are not counted
+    EXPECT_EQ(measureVertexCache(std::vector<unsigned int>{0, 2, 1, 3}, IndexEncoding::STRIPS).triangles, 2u);
+    EXPECT_EQ(measureVertexCache(std::vector<unsigned int>{0, 2, 2, 3, RESTART, 4, 5, 6}, IndexEncoding::STRIPS, RESTART).triangles, 1u);
+    
+    // A cache of two entries has already evicted vertex 0 on its return
+    EXPECT_EQ(measureVertexCache(std::vector<unsigned int>{0, 1, 2, 0, 2, 3}, IndexEncoding::TRIANGLES, RESTART, 2).misses, 5u);
+}
+
+TEST(VertexCacheTest, OptimizedListsKeepTriangles) {
+    for (int resolution : {2, 9, 65}) {
+        for (unsigned int edges : {0u, EDGE_NORTH | EDGE_EAST, EDGE_SOUTH | EDGE_EAST | EDGE_WEST}) {
+            std::vector<unsigned int> list = buildGridTriangles(resolution, edges);
+            std::vector<unsigned int> optimized = optimizeVertexCache(list, resolution * resolution);
+            EXPECT_EQ(sortedTriangles(optimized), sortedTriangles(list));
+        }
+    }
+}
+
+TEST(VertexCacheTest, BandedStripsMatchTriangles) {
+    for (int resolution : {3, 17, 65}) {
+        for (unsigned int edges = 0; edges < EDGE_MASK_COUNT; ++edges) {
+            // Expand the strips as GL does, skipping collapsed triangles
+            std::vector<unsigned int> strips = buildGridStrips(resolution, RESTART, edges, STRIP_BAND_CELLS);
+            std::vector<unsigned int> expanded;
+            std::size_t start = 0;
+            for (std::size_t i = 0; i <= strips.size(); ++i) {
+                if (i < strips.size() && strips[i] != RESTART) continue;
+                for (std::size_t k = start; k + 2 < i; ++k) {
+                    unsigned int a = strips[k], b = strips[k + 1], c = strips[k + 2];
+                    if (a == b || b == c || a == c) continue;
+                    if ((k - start) % 2 == 1) std::swap(a, b);
+                    expanded.insert(expanded.end(), {a, b, c});
+                }
+                start = i + 1;
+            }
+            EXPECT_EQ(sortedTriangles(expanded), sortedTriangles(buildGridTriangles(resolution, edges)))
+                << resolution << " mask " << edges;
+        }
+    }
+}
+
+TEST(VertexCacheTest, ChunkPatternsReuseVertices) {
+    // ACMR and ATVR of each shared chunk index pattern, before and after
+    // reordering
+    for (int resolution : {65, 33, 17, 9}) {
+        std::vector<unsigned int> rows = buildGridTriangles(resolution);
+        std::vector<unsigned int> optimized = optimizeVertexCache(rows, resolution * resolution);
+        std::vector<unsigned int> rowStrips = buildGridStrips(resolution, RESTART);
+        std::vector<unsigned int> bandStrips = buildGridStrips(resolution, RESTART, 0, STRIP_BAND_CELLS);
+        
+        VertexCacheStats rowList = measureVertexCache(rows, IndexEncoding::TRIANGLES);
+        VertexCacheStats optimizedList = measureVertexCache(optimized, IndexEncoding::TRIANGLES);
+        VertexCacheStats rowStrip = measureVertexCache(rowStrips, IndexEncoding::STRIPS, RESTART);
+        VertexCacheStats bandStrip = measureVertexCache(bandStrips, IndexEncoding::STRIPS, RESTART);
+        
+        EXPECT_LE(bandStrip.acmr(), rowStrip.acmr());
+        if (resolution > STRIP_BAND_CELLS + 1) {
+            // Rows fit in the cache on smaller grids, and row order is as
+            // good as it gets there
+            EXPECT_LT(optimizedList.acmr(), rowList.acmr());
+        }
+        if (resolution == 65) {
+            // Rows longer than the cache shade almost every vertex twice
+            EXPECT_GT(rowList.atvr(), 1.9);
+            EXPECT_LT(optimizedList.atvr(), 1.4);
+            EXPECT_LT(bandStrip.atvr(), 1.2);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include "VertexFormat.h"
+
+TEST(VertexFormatTest, ParseNames) {
+    EXPECT_EQ(parseVertexFormat("full"), VertexFormat::FULL);
+    EXPECT_EQ(parseVertexFormat("compact"), VertexFormat::COMPACT);
+    EXPECT_STREQ(vertexFormatName(VertexFormat::COMPACT), "compact");
+    EXPECT_EQ(vertexSize(VertexFormat::FULL), 36);
+    EXPECT_EQ(vertexSize(VertexFormat::COMPACT), 8);
+    EXPECT_EQ(parseVertexFormat("heightTile"), VertexFormat::HEIGHT_TILE);
+    EXPECT_STREQ(vertexFormatName(VertexFormat::HEIGHT_TILE), "heightTile");
+    EXPECT_EQ(vertexSize(VertexFormat::HEIGHT_TILE), 6);
+    EXPECT_THROW(parseVertexFormat("tiny"), std::runtime_error);
+}
+
+TEST(VertexFormatTest, HeightQuantizationWatertight) {
+    // Two neighbouring chunks with different ranges must decode a shared
+    // edge height to exactly the same value
+    HeightQuantization a = HeightQuantization::fromRange(-12.3f, 40.7f);
+    HeightQuantization b = HeightQuantization::fromRange(3.9f, 118.2f);
+    EXPECT_EQ(a.step, HeightQuantization::MIN_STEP);
+    EXPECT_EQ(a.step, b.step);
+    
+    for (int i = 0; i < 1000; ++i) {
+        float height = 3.9f + i * 0.0367f;
+        float decodedA = a.decode(a.encode(height));
+        EXPECT_EQ(decodedA, b.decode(b.encode(height)));
+        EXPECT_LE(std::abs(decodedA - height), a.step * 0.5f + 1e-4f);
+    }
+    
+    // Ranges wider than 65535 steps fall back to a coarser power-of-two step
+    HeightQuantization wide = HeightQuantization::fromRange(-2000.0f, 2000.0f);
+    EXPECT_GT(wide.step, HeightQuantization::MIN_STEP);
+    EXPECT_NEAR(wide.decode(wide.encode(1999.0f)), 1999.0f, wide.step);
+}
+
+TEST(VertexFormatTest, NormalRoundTrip) {
+    // Heightfield normals only cover the upper hemisphere
+    float worst = 1.0f;
+    for (int i = 0; i < 64; ++i) {
+        for (int j = 0; j < 64; ++j) {
+            glm::vec3 normal = glm::normalize(glm::vec3((i - 32) * 0.15f, 1.0f, (j - 32) * 0.15f));
+            std::int8_t encoded[2];
+            encodeHemiOctahedral(normal, encoded);
+            worst = std::min(worst, glm::dot(normal, decodeHemiOctahedral(encoded)));
+        }
+    }
+    // Within about one degree
+    EXPECT_GT(worst, std::cos(1.0f * 3.14159265f / 180.0f));
+}
+
+TEST(VertexFormatTest, ColorPacking) {
+    glm::vec3 color(0.96f, 0.87f, 0.5f);
+    glm::vec3 decoded = unpackColor565(packColor565(color));
+    EXPECT_NEAR(decoded.r, color.r, 0.5f / 31.0f);
+    EXPECT_NEAR(decoded.g, color.g, 0.5f / 63.0f);
+    EXPECT_NEAR(decoded.b, color.b, 0.5f / 31.0f);
+    
+    EXPECT_EQ(packColorRGBA8(glm::vec3(1.0f, 0.0f, 0.5f)), 0xFF8000FFu);
+    EXPECT_EQ(packColor565(glm::vec3(2.0f, -1.0f, 1.0f)), 0xF81Fu);
+}
\ No newline at end of file
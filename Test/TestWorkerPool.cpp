@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "WorkerPool.h"
+
+TEST(WorkerPoolTest, EveryResultComesBack) {
+    // Move-only results, as chunk builds are
+    WorkerPool<std::unique_ptr<int>> pool(4);
+    EXPECT_EQ(pool.getThreadCount(), 4);
+    for (int i = 0; i < 200; ++i) {
+        pool.submit([i] { return std::make_unique<int>(i); });
+    }
+    
+    std::vector<std::unique_ptr<int>> finished;
+    while (pool.getOutstanding() > 0) {
+        pool.collect(finished, true);
+    }
+    ASSERT_EQ(finished.size(), 200u);
+    std::vector<int> values;
+    for (const auto& value : finished) {
+        values.push_back(*value);
+    }
+    std::sort(values.begin(), values.end());
+    std::vector<int> expected(200);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(values, expected);
+    
+    // Nothing outstanding: waiting returns straight away
+    EXPECT_EQ(pool.collect(finished, true), 0u);
+}
+
+TEST(WorkerPoolTest, JobsRunConcurrently) {
+    WorkerPool<std::thread::id> pool(4);
+    std::atomic<int> running = 0;
+    std::atomic<int> mostRunning = 0;
+    for (int i = 0; i < 16; ++i) {
+        pool.submit([&] {
+            int now = ++running;
+            int most = mostRunning.load();
+            while (now > most && !mostRunning.compare_exchange_weak(most, now)) {
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            --running;
+            return std::this_thread::get_id();
+        });
+    }
+    
+    std::vector<std::thread::id> finished;
+    while (pool.getOutstanding() > 0) {
+        pool.collect(finished, true);
+    }
+    std::set<std::thread::id> threads(finished.begin(), finished.end());
+    EXPECT_GT(mostRunning.load(), 1);
+    EXPECT_GT(threads.size(), 1u);
+    EXPECT_EQ(threads.count(std::this_thread::get_id()), 0u);
+}
+
+TEST(WorkerPoolTest, FailureRethrowsOnCollect) {
+    WorkerPool<int> pool(2);
+    pool.submit([] { return 1; });
+    pool.submit([]() -> int { throw std::runtime_error("generation failed"); });
+    
+    std::vector<int> finished;
+    bool threw = false;
+    while (pool.getOutstanding() > 0) {
+        try {
+            pool.collect(finished, true);
+        } catch (const std::runtime_error& error) {
+            EXPECT_STREQ(error.what(), "generation failed");
+            threw = true;
+        }
+    }
+    EXPECT_TRUE(threw);
+    EXPECT_EQ(finished, std::vector<int>{1});
+    
+    // The pool carries on afterwards
+    pool.submit([] { return 2; });
+    pool.collect(finished, true);
+    EXPECT_EQ(finished, (std::vector<int>{1, 2}));
+}
+
+TEST(WorkerPoolTest, FailureKeepsResultsFinishedWithIt) {
+    // One thread runs the jobs in order, so once the last has started the
+    // three before it have all finished
+    WorkerPool<int> pool(1);
+    std::atomic<bool> started = false;
+    std::atomic<bool> release = false;
+    pool.submit([] { return 1; });
+    pool.submit([]() -> int { throw std::runtime_error("generation failed"); });
+    pool.submit([] { return 3; });
+    pool.submit([&] {
+        started = true;
+        while (!release) {
+            std::this_thread::yield();
+        }
+        return 4;
+    });
+    while (!started) {
+        std::this_thread::yield();
+    }
+    
+    // Results on either side of the failure are handed over before it is
+    // rethrown, so the owner can account for every job
+    std::vector<int> finished;
+    EXPECT_THROW(pool.collect(finished), std::runtime_error);
+    EXPECT_EQ(finished, (std::vector<int>{1, 3}));
+    EXPECT_EQ(pool.getOutstanding(), 1u);
+    
+    release = true;
+    pool.collect(finished, true);
+    EXPECT_EQ(finished, (std::vector<int>{1, 3, 4}));
+}
+
+TEST(WorkerPoolTest, DestroyDropsQueuedJobs) {
+    std::atomic<int> started = 0;
+    {
+        WorkerPool<int> pool(1);
+        for (int i = 0; i < 100; ++i) {
+            pool.submit([&started] {
+                started++;
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                return 0;
+            });
+        }
+    }
+    EXPECT_LT(started.load(), 100);
+}
\ No newline at end of file